@@ -0,0 +1,258 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+/*
+ * Маршрутизатор "по требованию": в отличие от Router не хранит таблицу
+ * кратчайших путей между всеми парами вершин, а выполняет поиск A* на каждый запрос.
+ * Эвристика должна возвращать нижнюю оценку веса пути от вершины до цели
+ * (при нулевой эвристике поиск вырождается в алгоритм Дейкстры)
+ */
+template <typename Weight>
+class AStarRouter {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    // Вершина начала или конца пути и дополнительный вес, с которым путь в ней начинается или заканчивается
+    using Endpoint = std::pair<VertexId, Weight>;
+
+    // Путь между вершинами from и to, выбранными среди нескольких вершин начала и конца
+    struct EndpointsRouteInfo {
+        VertexId from;
+        VertexId to;
+        RouteInfo route;
+    };
+
+    explicit AStarRouter(const Graph& graph)
+        : graph_(graph) {
+    }
+
+    template <typename Heuristic>
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, Heuristic heuristic) const;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const {
+        return BuildRoute(from, to, ZeroHeuristic);
+    }
+
+    // Возвращает кратчайший путь от любой из вершин sources до любой из вершин targets с учетом их
+    // дополнительных весов за один поиск. Вес route включает дополнительный вес начала, но не конца.
+    // Эвристика должна возвращать нижнюю оценку веса пути до ближайшей цели вместе с ее весом
+    template <typename Heuristic>
+    std::optional<EndpointsRouteInfo> BuildRoute(const std::vector<Endpoint>& sources,
+                                                 const std::vector<Endpoint>& targets, Heuristic heuristic) const;
+
+    // Возвращает веса кратчайших путей от вершины from до всех вершин графа
+    // (std::nullopt для недостижимых вершин)
+    std::vector<std::optional<Weight>> ComputeWeightsFrom(VertexId from) const;
+
+    // Возвращает вершины, достижимые из from путями веса не больше limit, и веса кратчайших путей
+    // до них в порядке неубывания веса. Вершины дальше limit поиском не раскрываются
+    std::vector<std::pair<VertexId, Weight>> ComputeWeightsWithin(VertexId from, const Weight& limit) const;
+
+private:
+    struct SearchState {
+        explicit SearchState(size_t vertex_count)
+            : weights(vertex_count)
+            , prev_edges(vertex_count)
+            , settled(vertex_count, false) {
+        }
+
+        std::vector<std::optional<Weight>> weights;
+        std::vector<std::optional<EdgeId>> prev_edges;
+        std::vector<bool> settled;
+
+        // Вершины в порядке их окончательной обработки (неубывания веса пути при нулевой эвристике)
+        std::vector<VertexId> settled_order;
+    };
+
+    struct QueueItem {
+        Weight estimate;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return estimate > other.estimate;
+        }
+    };
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    static Weight ZeroHeuristic(VertexId) {
+        return ZERO_WEIGHT;
+    }
+
+    // Выполняет поиск из вершины from, пока не будет достигнута вершина to
+    // (или пока не будут пройдены все достижимые вершины, если to не задана).
+    // Если задан limit, вершины с весом пути больше limit не обрабатываются
+    template <typename Heuristic>
+    void Search(VertexId from, std::optional<VertexId> to, Heuristic heuristic, SearchState& state,
+                const std::optional<Weight>& limit = std::nullopt) const;
+
+    // Восстанавливает ребра пути до вершины to по результатам поиска
+    std::vector<EdgeId> BuildEdges(const SearchState& state, VertexId to) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+template <typename Heuristic>
+void AStarRouter<Weight>::Search(VertexId from, std::optional<VertexId> to, Heuristic heuristic,
+                                 SearchState& state, const std::optional<Weight>& limit) const {
+    Queue queue;
+    state.weights.at(from) = ZERO_WEIGHT;
+    queue.push({heuristic(from), from});
+
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().vertex;
+        queue.pop();
+        if (state.settled[vertex]) {
+            continue;
+        }
+        if (limit && *limit < *state.weights[vertex]) {
+            return;
+        }
+        state.settled[vertex] = true;
+        state.settled_order.push_back(vertex);
+        if (vertex == to) {
+            return;
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (state.settled[edge.to]) {
+                continue;
+            }
+            const Weight candidate = *state.weights[vertex] + edge.weight;
+            auto& weight_to = state.weights[edge.to];
+            if (!weight_to || candidate < *weight_to) {
+                weight_to = candidate;
+                state.prev_edges[edge.to] = edge_id;
+                queue.push({candidate + heuristic(edge.to), edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+template <typename Heuristic>
+std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(
+    VertexId from, VertexId to, Heuristic heuristic) const {
+    SearchState state(graph_.GetVertexCount());
+    Search(from, to, heuristic, state);
+
+    if (!state.weights.at(to)) {
+        return std::nullopt;
+    }
+    return RouteInfo{*state.weights[to], BuildEdges(state, to)};
+}
+
+template <typename Weight>
+template <typename Heuristic>
+std::optional<typename AStarRouter<Weight>::EndpointsRouteInfo> AStarRouter<Weight>::BuildRoute(
+    const std::vector<Endpoint>& sources, const std::vector<Endpoint>& targets, Heuristic heuristic) const {
+    SearchState state(graph_.GetVertexCount());
+    Queue queue;
+    for (const auto& [vertex, weight] : sources) {
+        auto& source_weight = state.weights.at(vertex);
+        if (!source_weight || weight < *source_weight) {
+            source_weight = weight;
+            queue.push({weight + heuristic(vertex), vertex});
+        }
+    }
+
+    // Наилучший найденный путь: полный вес с весом конца и вершина конца
+    std::optional<Weight> best_weight;
+    VertexId best_target = 0;
+
+    while (!queue.empty()) {
+        const auto [estimate, vertex] = queue.top();
+        queue.pop();
+        if (state.settled[vertex]) {
+            continue;
+        }
+        // Оценки всех оставшихся путей не лучше найденного
+        if (best_weight && !(estimate < *best_weight)) {
+            break;
+        }
+        state.settled[vertex] = true;
+
+        for (const auto& [target, target_weight] : targets) {
+            if (target == vertex) {
+                const Weight candidate = *state.weights[vertex] + target_weight;
+                if (!best_weight || candidate < *best_weight) {
+                    best_weight = candidate;
+                    best_target = vertex;
+                }
+            }
+        }
+
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            if (state.settled[edge.to]) {
+                continue;
+            }
+            const Weight candidate = *state.weights[vertex] + edge.weight;
+            auto& weight_to = state.weights[edge.to];
+            if (!weight_to || candidate < *weight_to) {
+                weight_to = candidate;
+                state.prev_edges[edge.to] = edge_id;
+                queue.push({candidate + heuristic(edge.to), edge.to});
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges = BuildEdges(state, best_target);
+    const VertexId from = (edges.empty()) ? best_target : graph_.GetEdge(edges.front()).from;
+    return EndpointsRouteInfo{from, best_target, RouteInfo{*state.weights[best_target], std::move(edges)}};
+}
+
+template <typename Weight>
+std::vector<EdgeId> AStarRouter<Weight>::BuildEdges(const SearchState& state, VertexId to) const {
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = state.prev_edges[to];
+         edge_id;
+         edge_id = state.prev_edges[graph_.GetEdge(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return edges;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> AStarRouter<Weight>::ComputeWeightsFrom(VertexId from) const {
+    SearchState state(graph_.GetVertexCount());
+    Search(from, std::nullopt, ZeroHeuristic, state);
+    return std::move(state.weights);
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> AStarRouter<Weight>::ComputeWeightsWithin(VertexId from,
+                                                                                   const Weight& limit) const {
+    SearchState state(graph_.GetVertexCount());
+    Search(from, std::nullopt, ZeroHeuristic, state, limit);
+
+    std::vector<std::pair<VertexId, Weight>> result;
+    result.reserve(state.settled_order.size());
+    for (const VertexId vertex : state.settled_order) {
+        result.emplace_back(vertex, *state.weights[vertex]);
+    }
+    return result;
+}
+
+}  // namespace graph
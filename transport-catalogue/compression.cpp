@@ -0,0 +1,460 @@
+#include "compression.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace compression {
+
+    namespace {
+
+        constexpr std::array<uint32_t, 256> CRC32_TABLE = [] {
+            std::array<uint32_t, 256> table{};
+            for (uint32_t i = 0; i < table.size(); ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }();
+
+        // Параметры LZ77: окно, границы длины повтора, размер таблицы хешей и наибольшая длина
+        // просматриваемой цепочки кандидатов
+        constexpr size_t WINDOW_SIZE = 32768;
+        constexpr size_t MIN_MATCH = 3;
+        constexpr size_t MAX_MATCH = 258;
+        constexpr int HASH_BITS = 15;
+        constexpr int MAX_CHAIN = 64;
+        constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+
+        // Наибольший размер блока без сжатия
+        constexpr size_t MAX_STORED_BLOCK_SIZE = 65535;
+
+        // Размер части, которую GzipStreamBuf накапливает перед сжатием
+        constexpr size_t STREAM_CHUNK_SIZE = 131072;
+
+        // Символ конца блока в алфавите литералов и длин
+        constexpr int END_OF_BLOCK = 256;
+
+        // Начальные длины повторов и число дополнительных бит для символов 257-285
+        constexpr std::array<uint16_t, 29> LENGTH_BASES = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        constexpr std::array<uint8_t, 29> LENGTH_EXTRA_BITS = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+
+        // Начальные расстояния повторов и число дополнительных бит для кодов расстояний 0-29
+        constexpr std::array<uint16_t, 30> DISTANCE_BASES = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+        };
+        constexpr std::array<uint8_t, 30> DISTANCE_EXTRA_BITS = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+
+        // Записывает биты в строку, начиная с младшего бита каждого байта, как требует deflate
+        class BitWriter {
+        public:
+
+            // bits и bits_count - неполный байт, оставшийся от предыдущей записи в тот же поток
+            explicit BitWriter(std::string& out, uint64_t bits = 0, int bits_count = 0)
+                : out_(out)
+                , buffer_(bits)
+                , buffer_size_(bits_count)
+            {
+            }
+
+            // Записывает count младших бит value, начиная с младшего
+            void Write(uint32_t value, int count) {
+                buffer_ |= static_cast<uint64_t>(value) << buffer_size_;
+                buffer_size_ += count;
+                while (buffer_size_ >= 8) {
+                    out_.push_back(static_cast<char>(buffer_ & 0xFF));
+                    buffer_ >>= 8;
+                    buffer_size_ -= 8;
+                }
+            }
+
+            // Записывает код Хаффмана длины count: коды записываются начиная со старшего бита
+            void WriteCode(uint32_t code, int count) {
+                uint32_t reversed = 0;
+                for (int i = 0; i < count; ++i) {
+                    reversed = (reversed << 1) | ((code >> i) & 1);
+                }
+                Write(reversed, count);
+            }
+
+            // Дописывает неполный последний байт, дополняя его нулевыми битами до границы байта
+            void Flush() {
+                if (buffer_size_ > 0) {
+                    out_.push_back(static_cast<char>(buffer_ & 0xFF));
+                }
+                buffer_ = 0;
+                buffer_size_ = 0;
+            }
+
+            // Записывает байты data как есть (только на границе байта, после Flush)
+            void WriteBytes(std::string_view data) {
+                out_.append(data);
+            }
+
+            uint64_t GetBits() const {
+                return buffer_;
+            }
+
+            int GetBitsCount() const {
+                return buffer_size_;
+            }
+
+        private:
+            std::string& out_;
+            uint64_t buffer_ = 0;
+            int buffer_size_ = 0;
+        };
+
+        // Длина фиксированного кода Хаффмана символа алфавита литералов и длин
+        int GetLiteralLengthBits(int symbol) {
+            return (symbol < 144) ? 8 : (symbol < 256) ? 9 : (symbol < 280) ? 7 : 8;
+        }
+
+        // Индексы кода длины в LENGTH_BASES и кода расстояния в DISTANCE_BASES
+        size_t GetLengthCode(size_t length) {
+            return std::upper_bound(LENGTH_BASES.begin(), LENGTH_BASES.end(), length) - LENGTH_BASES.begin() - 1;
+        }
+
+        size_t GetDistanceCode(size_t distance) {
+            return std::upper_bound(DISTANCE_BASES.begin(), DISTANCE_BASES.end(), distance) - DISTANCE_BASES.begin() - 1;
+        }
+
+        // Записывает символ алфавита литералов и длин фиксированным кодом Хаффмана (RFC 1951, 3.2.6)
+        void WriteLiteralLengthSymbol(BitWriter& writer, int symbol) {
+            if (symbol < 144) {
+                writer.WriteCode(0x30 + symbol, 8);
+            }
+            else if (symbol < 256) {
+                writer.WriteCode(0x190 + (symbol - 144), 9);
+            }
+            else if (symbol < 280) {
+                writer.WriteCode(symbol - 256, 7);
+            }
+            else {
+                writer.WriteCode(0xC0 + (symbol - 280), 8);
+            }
+        }
+
+        // Количество бит повтора в блоке с фиксированными кодами
+        size_t GetMatchBits(size_t length, size_t distance) {
+            const size_t length_code = GetLengthCode(length);
+            return GetLiteralLengthBits(static_cast<int>(257 + length_code)) + LENGTH_EXTRA_BITS[length_code]
+                + 5 + DISTANCE_EXTRA_BITS[GetDistanceCode(distance)];
+        }
+
+        void WriteMatch(BitWriter& writer, size_t length, size_t distance) {
+            const size_t length_code = GetLengthCode(length);
+            WriteLiteralLengthSymbol(writer, static_cast<int>(257 + length_code));
+            writer.Write(static_cast<uint32_t>(length - LENGTH_BASES[length_code]), LENGTH_EXTRA_BITS[length_code]);
+
+            // Коды расстояний фиксированного блока - пятибитные числа
+            const size_t distance_code = GetDistanceCode(distance);
+            writer.WriteCode(static_cast<uint32_t>(distance_code), 5);
+            writer.Write(static_cast<uint32_t>(distance - DISTANCE_BASES[distance_code]), DISTANCE_EXTRA_BITS[distance_code]);
+        }
+
+        // Поиск повторов: для каждого хеша трех байт хранится последняя позиция (head_),
+        // для каждой позиции окна - предыдущая позиция с тем же хешем (prev_)
+        class MatchFinder {
+        public:
+
+            struct Match {
+                size_t length = 0;
+                size_t distance = 0;
+            };
+
+            explicit MatchFinder(std::string_view data)
+                : data_(data)
+                , head_(size_t(1) << HASH_BITS, NO_POSITION)
+                , prev_(WINDOW_SIZE, NO_POSITION)
+            {
+            }
+
+            // Возвращает самый длинный повтор для позиции pos среди добавленных ранее позиций
+            Match Find(size_t pos) const {
+                Match result;
+                if (pos + MIN_MATCH > data_.size()) {
+                    return result;
+                }
+                const size_t max_length = std::min(MAX_MATCH, data_.size() - pos);
+
+                uint32_t candidate = head_[Hash(pos)];
+                for (int chain = 0; chain < MAX_CHAIN && candidate != NO_POSITION; ++chain) {
+                    if (pos - candidate > WINDOW_SIZE) {
+                        break;
+                    }
+                    // Сначала сравнивается байт, на котором должен закончиться более длинный повтор
+                    if (data_[candidate + result.length] == data_[pos + result.length]) {
+                        size_t length = 0;
+                        while (length < max_length && data_[candidate + length] == data_[pos + length]) {
+                            ++length;
+                        }
+                        if (length > result.length) {
+                            result = { length, pos - candidate };
+                            if (length == max_length) {
+                                break;
+                            }
+                        }
+                    }
+                    // Позиции цепочки убывают, иначе ячейка prev_ уже занята более новой позицией
+                    const uint32_t next = prev_[candidate % WINDOW_SIZE];
+                    if (next >= candidate) {
+                        break;
+                    }
+                    candidate = next;
+                }
+                return (result.length >= MIN_MATCH) ? result : Match{};
+            }
+
+            // Добавляет позицию pos в цепочку своего хеша
+            void Insert(size_t pos) {
+                if (pos + MIN_MATCH > data_.size()) {
+                    return;
+                }
+                uint32_t& head = head_[Hash(pos)];
+                prev_[pos % WINDOW_SIZE] = head;
+                head = static_cast<uint32_t>(pos);
+            }
+
+        private:
+            std::string_view data_;
+            std::vector<uint32_t> head_;
+            std::vector<uint32_t> prev_;
+
+            size_t Hash(size_t pos) const {
+                const uint32_t bytes = static_cast<uint8_t>(data_[pos])
+                    | (static_cast<uint32_t>(static_cast<uint8_t>(data_[pos + 1])) << 8)
+                    | (static_cast<uint32_t>(static_cast<uint8_t>(data_[pos + 2])) << 16);
+                return (bytes * 2654435761u) >> (32 - HASH_BITS);
+            }
+        };
+
+        // Записывает data блоками без сжатия: у каждого блока заголовок из трех бит с признаком
+        // последнего блока и типом 00, затем с границы байта длина, ее дополнение и сами данные
+        void WriteStoredBlocks(BitWriter& writer, std::string_view data, bool is_last) {
+            size_t pos = 0;
+            do {
+                const size_t size = std::min(MAX_STORED_BLOCK_SIZE, data.size() - pos);
+                writer.Write((is_last && pos + size == data.size()) ? 1 : 0, 1);
+                writer.Write(0, 2);
+                writer.Flush();
+                writer.Write(static_cast<uint32_t>(size), 16);
+                writer.Write(static_cast<uint32_t>(~size & 0xFFFF), 16);
+                writer.WriteBytes(data.substr(pos, size));
+                pos += size;
+            } while (pos < data.size());
+        }
+
+        /*
+         * Сжимает часть input, начинающуюся с позиции begin: повторы ищутся и в предыдущих байтах input.
+         * Часть записывается одним блоком с фиксированными кодами Хаффмана или, если так данные
+         * не уменьшаются (каждый байт дал бы 8-9 бит), блоками без сжатия
+         */
+        void WriteBlocks(BitWriter& writer, std::string_view input, size_t begin, bool is_last) {
+            // Повтор длины length на расстоянии value или литерал value при length == 0
+            struct Token {
+                uint16_t length = 0;
+                uint16_t value = 0;
+            };
+            std::vector<Token> tokens;
+            tokens.reserve((input.size() - begin) / 4 + 1);
+
+            MatchFinder finder(input);
+            for (size_t pos = 0; pos < begin; ++pos) {
+                finder.Insert(pos);
+            }
+
+            // Заголовок блока и символ конца блока
+            size_t compressed_bits = 3 + GetLiteralLengthBits(END_OF_BLOCK);
+            size_t pos = begin;
+            while (pos < input.size()) {
+                const auto match = finder.Find(pos);
+                if (match.length == 0) {
+                    const uint8_t literal = static_cast<uint8_t>(input[pos]);
+                    tokens.push_back({ 0, literal });
+                    compressed_bits += GetLiteralLengthBits(literal);
+                    finder.Insert(pos);
+                    ++pos;
+                    continue;
+                }
+                tokens.push_back({ static_cast<uint16_t>(match.length), static_cast<uint16_t>(match.distance) });
+                compressed_bits += GetMatchBits(match.length, match.distance);
+                for (const size_t end = pos + match.length; pos < end; ++pos) {
+                    finder.Insert(pos);
+                }
+            }
+
+            // Блок без сжатия: заголовок, выравнивание до байта, длина и ее дополнение, данные
+            const size_t size = input.size() - begin;
+            const size_t stored_bits = (size / MAX_STORED_BLOCK_SIZE + 1) * (3 + 7 + 32) + size * 8;
+            if (compressed_bits > stored_bits) {
+                WriteStoredBlocks(writer, input.substr(begin), is_last);
+                return;
+            }
+
+            writer.Write(is_last ? 1 : 0, 1);
+            writer.Write(1, 2);
+            for (const Token& token : tokens) {
+                if (token.length == 0) {
+                    WriteLiteralLengthSymbol(writer, token.value);
+                }
+                else {
+                    WriteMatch(writer, token.length, token.value);
+                }
+            }
+            WriteLiteralLengthSymbol(writer, END_OF_BLOCK);
+        }
+
+        uint32_t UpdateCrc32(uint32_t crc, std::string_view data) {
+            for (const char c : data) {
+                crc = CRC32_TABLE[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+        void WriteLittleEndian(std::string& out, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+            }
+        }
+
+    } // namespace
+
+    uint32_t ComputeCrc32(std::string_view data) {
+        return UpdateCrc32(0xFFFFFFFFu, data) ^ 0xFFFFFFFFu;
+    }
+
+    void DeflateEncoder::Encode(std::string_view data, bool is_last, std::string& out) {
+        if (data.empty() && !is_last) {
+            return;
+        }
+
+        // Новая часть дописывается к окну, только если оно не пусто
+        std::string buffer;
+        std::string_view input = data;
+        if (!window_.empty()) {
+            buffer.reserve(window_.size() + data.size());
+            buffer.append(window_).append(data);
+            input = buffer;
+        }
+
+        BitWriter writer(out, bits_, bits_count_);
+        WriteBlocks(writer, input, input.size() - data.size(), is_last);
+        if (is_last) {
+            writer.Flush();
+        }
+        bits_ = writer.GetBits();
+        bits_count_ = writer.GetBitsCount();
+
+        window_.assign(input.substr(input.size() - std::min(WINDOW_SIZE, input.size())));
+    }
+
+    std::string Deflate(std::string_view data) {
+        std::string result;
+        result.reserve(data.size() / 4 + 16);
+        DeflateEncoder().Encode(data, true, result);
+        return result;
+    }
+
+    std::string Gzip(std::string_view data) {
+        std::string result(GZIP_HEADER);
+        result += Deflate(data);
+        WriteLittleEndian(result, ComputeCrc32(data));
+        WriteLittleEndian(result, static_cast<uint32_t>(data.size()));
+        return result;
+    }
+
+    GzipStreamBuf::GzipStreamBuf(std::ostream& out)
+        : out_(out)
+        , buffer_(STREAM_CHUNK_SIZE)
+    {
+        out_.write(GZIP_HEADER.data(), GZIP_HEADER.size());
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    GzipStreamBuf::~GzipStreamBuf() {
+        Finish();
+    }
+
+    void GzipStreamBuf::Finish() {
+        if (is_finished_) {
+            return;
+        }
+        CompressBuffer(true);
+        is_finished_ = true;
+
+        std::string trailer;
+        WriteLittleEndian(trailer, crc_ ^ 0xFFFFFFFFu);
+        WriteLittleEndian(trailer, static_cast<uint32_t>(size_));
+        out_.write(trailer.data(), trailer.size());
+        out_.flush();
+    }
+
+    GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type ch) {
+        if (is_finished_) {
+            return traits_type::eof();
+        }
+        CompressBuffer(false);
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    void GzipStreamBuf::CompressBuffer(bool is_last) {
+        const std::string_view data(pbase(), pptr() - pbase());
+        crc_ = UpdateCrc32(crc_, data);
+        size_ += data.size();
+
+        compressed_.clear();
+        encoder_.Encode(data, is_last, compressed_);
+        out_.write(compressed_.data(), compressed_.size());
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    std::string EncodeBase64(std::string_view data) {
+        static constexpr std::string_view ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string result;
+        result.reserve((data.size() + 2) / 3 * 4);
+        size_t pos = 0;
+        for (; pos + 3 <= data.size(); pos += 3) {
+            const uint32_t group = (static_cast<uint32_t>(static_cast<uint8_t>(data[pos])) << 16)
+                | (static_cast<uint32_t>(static_cast<uint8_t>(data[pos + 1])) << 8)
+                | static_cast<uint8_t>(data[pos + 2]);
+            result.push_back(ALPHABET[(group >> 18) & 0x3F]);
+            result.push_back(ALPHABET[(group >> 12) & 0x3F]);
+            result.push_back(ALPHABET[(group >> 6) & 0x3F]);
+            result.push_back(ALPHABET[group & 0x3F]);
+        }
+
+        // Последняя неполная группа дополняется символами '='
+        if (const size_t rest = data.size() - pos; rest > 0) {
+            uint32_t group = static_cast<uint32_t>(static_cast<uint8_t>(data[pos])) << 16;
+            if (rest == 2) {
+                group |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos + 1])) << 8;
+            }
+            result.push_back(ALPHABET[(group >> 18) & 0x3F]);
+            result.push_back(ALPHABET[(group >> 12) & 0x3F]);
+            result.push_back((rest == 2) ? ALPHABET[(group >> 6) & 0x3F] : '=');
+            result.push_back('=');
+        }
+        return result;
+    }
+
+} // namespace compression
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace compression {
+
+    // Контрольная сумма CRC-32 (многочлен 0xEDB88320, как в gzip и zlib)
+    uint32_t ComputeCrc32(std::string_view data);
+
+    /*
+     * Сжимает data в поток формата deflate (RFC 1951). Повторы ищутся методом LZ77 по цепочкам
+     * хешей в окне 32 КБ, литералы и повторы кодируются фиксированными кодами Хаффмана одним блоком.
+     * Для повторяющегося текста SVG-карты этого достаточно, чтобы уменьшить объем в несколько раз.
+     * Если сжатие не уменьшает данные, они записываются блоками без сжатия
+     */
+    std::string Deflate(std::string_view data);
+
+    /*
+     * Поточное сжатие deflate: данные передаются частями, повторы ищутся и в предыдущих частях
+     * в пределах окна 32 КБ. Каждая часть записывается отдельным блоком, как в Deflate
+     */
+    class DeflateEncoder {
+    public:
+        // Сжимает очередную часть data и дописывает результат в out. После последней части
+        // (is_last) поток дополняется до границы байта и кодировщик больше не используется
+        void Encode(std::string_view data, bool is_last, std::string& out);
+
+    private:
+        // Последние до 32 КБ исходных данных и неполный байт, оставшийся после предыдущей части
+        std::string window_;
+        uint64_t bits_ = 0;
+        int bits_count_ = 0;
+    };
+
+    // Заголовок gzip: сигнатура, метод deflate, без флагов и времени изменения, ОС не указана
+    inline constexpr std::string_view GZIP_HEADER{ "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10 };
+
+    // Сжимает data в формат gzip (RFC 1952): заголовок, поток deflate, CRC-32 и размер исходных данных
+    std::string Gzip(std::string_view data);
+
+    /*
+     * Буфер потока, который сжимает все записанное в него в формат gzip и выводит в поток out.
+     * Данные накапливаются частями по 128 КБ, каждая часть сжимается DeflateEncoder и сразу
+     * выводится, поэтому объем памяти не зависит от размера данных. Заголовок выводится
+     * в конструкторе, последний блок, CRC-32 и размер - методом Finish или в деструкторе
+     */
+    class GzipStreamBuf : public std::streambuf {
+    public:
+        explicit GzipStreamBuf(std::ostream& out);
+        ~GzipStreamBuf() override;
+
+        // Сжимает остаток данных и завершает поток gzip, после этого данные записывать нельзя
+        void Finish();
+
+    protected:
+        int_type overflow(int_type ch) override;
+
+    private:
+        std::ostream& out_;
+        std::vector<char> buffer_;
+        std::string compressed_;
+        DeflateEncoder encoder_;
+        uint32_t crc_ = 0xFFFFFFFFu;
+        uint64_t size_ = 0;
+        bool is_finished_ = false;
+
+        // Сжимает накопленные в буфере данные и выводит результат в out_
+        void CompressBuffer(bool is_last);
+    };
+
+    // Кодирует data в base64 (RFC 4648) со стандартным алфавитом и дополнением '='
+    std::string EncodeBase64(std::string_view data);
+
+} // namespace compression
@@ -0,0 +1,61 @@
+#include "distance_table.h"
+
+#include <utility>
+
+namespace transport_catalogue {
+
+	namespace detail {
+
+		void DistanceTable::Set(uint32_t from_id, uint32_t to_id, int distance) {
+			Insert(PackKey(from_id, to_id), distance, true);
+			if (from_id != to_id) {
+				Insert(PackKey(to_id, from_id), distance, false);
+			}
+		}
+
+		int DistanceTable::Get(uint32_t from_id, uint32_t to_id) const {
+			if (entries_.empty()) {
+				return 0;
+			}
+			const Entry& entry = entries_[FindSlot(PackKey(from_id, to_id))];
+			return (entry.key == EMPTY_KEY) ? 0 : entry.distance;
+		}
+
+		std::size_t DistanceTable::FindSlot(uint64_t key) const {
+			const std::size_t mask = entries_.size() - 1;
+			std::size_t slot = MixHash(key) & mask;
+			while (entries_[slot].key != key && entries_[slot].key != EMPTY_KEY) {
+				slot = (slot + 1) & mask;
+			}
+			return slot;
+		}
+
+		void DistanceTable::Insert(uint64_t key, int distance, bool is_explicit) {
+			if ((size_ + 1) * 2 > entries_.size()) {
+				Grow();
+			}
+
+			Entry& entry = entries_[FindSlot(key)];
+			if (entry.key == EMPTY_KEY) {
+				entry = Entry{ key, distance, is_explicit };
+				++size_;
+			}
+			else if (is_explicit || !entry.is_explicit) {
+				entry.distance = distance;
+				entry.is_explicit = is_explicit;
+			}
+		}
+
+		void DistanceTable::Grow() {
+			std::vector<Entry> old_entries(entries_.empty() ? 16 : entries_.size() * 2);
+			std::swap(old_entries, entries_);
+			for (const Entry& entry : old_entries) {
+				if (entry.key != EMPTY_KEY) {
+					entries_[FindSlot(entry.key)] = entry;
+				}
+			}
+		}
+
+	} // namespace detail
+
+} // namespace transport_catalogue
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace transport_catalogue {
+
+	namespace detail {
+
+		// Перемешивающая хеш-функция (финализатор splitmix64): каждый бит ключа
+		// влияет на все биты результата, поэтому близкие ключи не попадают в соседние ячейки
+		inline uint64_t MixHash(uint64_t key) {
+			key ^= key >> 30;
+			key *= 0xbf58476d1ce4e5b9ULL;
+			key ^= key >> 27;
+			key *= 0x94d049bb133111ebULL;
+			key ^= key >> 31;
+			return key;
+		}
+
+		/*
+		 * Таблица "действительных" расстояний между остановками с открытой адресацией
+		 * (линейное пробирование). Ключ - пара идентификаторов остановок, упакованная в 64 бита.
+		 * Расстояние в обратном направлении, если оно не задано явно, записывается в таблицу
+		 * при добавлении прямого, поэтому поиск расстояния - это одно обращение к таблице
+		 */
+		class DistanceTable {
+		public:
+
+			// Задает расстояние от остановки from_id до остановки to_id
+			// и, если обратное расстояние не задано явно, от to_id до from_id
+			void Set(uint32_t from_id, uint32_t to_id, int distance);
+
+			// Возвращает расстояние от остановки from_id до остановки to_id (0, если оно не задано)
+			int Get(uint32_t from_id, uint32_t to_id) const;
+
+		private:
+
+			static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+			struct Entry {
+				uint64_t key = EMPTY_KEY;
+				int distance = 0;
+				// Задано ли расстояние явно (а не взято из обратного направления)
+				bool is_explicit = false;
+			};
+
+			// Размер таблицы - степень двойки, заполненность не превышает половины
+			std::vector<Entry> entries_;
+			std::size_t size_ = 0;
+
+			static uint64_t PackKey(uint32_t from_id, uint32_t to_id) {
+				return (static_cast<uint64_t>(from_id) << 32) | to_id;
+			}
+
+			// Возвращает ячейку с ключом key или пустую ячейку, в которую его нужно записать
+			std::size_t FindSlot(uint64_t key) const;
+
+			// Записывает расстояние по ключу key, не заменяя явно заданное значение неявным
+			void Insert(uint64_t key, int distance, bool is_explicit);
+
+			// Увеличивает размер таблицы вдвое и заново раскладывает записи
+			void Grow();
+		};
+
+	} // namespace detail
+
+} // namespace transport_catalogue
@@ -1,21 +1,48 @@
 #pragma once
 
-#include <string>
-#include <vector>
+#include <cstdint>
+#include <span>
+#include <string_view>
 
 #include "geo.h"
 
 namespace domain {
 
+	// Названия остановок и маршрутов хранятся в пуле строк TransportCatalogue,
+	// последовательности остановок и расстояния маршрутов - в его непрерывной памяти
+
 	struct Stop {
-		std::string name;
+		std::string_view name;
 		geo::Coordinates coordinates;
+		// Синус и косинус широты для geo::ComputeDistance (вычисляются TransportCatalogue при добавлении)
+		geo::LatitudeTrig latitude_trig = {};
+		// Порядковый номер остановки в TransportCatalogue (назначается при добавлении)
+		uint32_t id = 0;
+		// Дескриптор названия в пуле строк TransportCatalogue (назначается при добавлении)
+		uint32_t name_handle = 0;
+		// Номер изменения TransportCatalogue, в котором остановка добавлена
+		uint64_t revision = 0;
 	};
 
 	struct Bus {
-		std::string name;
-		std::vector<const Stop*> bus_stops;
+		std::string_view name;
+		std::span<const Stop* const> bus_stops;
 		bool is_roundtrip = false;
+		// Порядковый номер маршрута в TransportCatalogue (назначается при добавлении)
+		uint32_t id = 0;
+		// Дескриптор названия в пуле строк TransportCatalogue (назначается при добавлении)
+		uint32_t name_handle = 0;
+		// Префиксные суммы "действительных" расстояний: route_distances[i] - расстояние
+		// от bus_stops[0] до bus_stops[i] по маршруту (заполняются TransportCatalogue)
+		std::span<int> route_distances = {};
+		// Номер изменения TransportCatalogue, в котором маршрут добавлен или последний раз изменен.
+		// По нему проверяется, что данные, сохраненные по маршруту, не устарели
+		uint64_t revision = 0;
+
+		// Возвращает расстояние по маршруту между остановками с индексами from_index и to_index
+		int GetDistance(size_t from_index, size_t to_index) const {
+			return route_distances[to_index] - route_distances[from_index];
+		}
 	};
 	
 } // namespace domain
\ No newline at end of file
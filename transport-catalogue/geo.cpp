@@ -7,16 +7,30 @@ namespace geo {
 
    const double EPSILON = 1e-6;
 
+   const double DR = 3.1415926535 / 180.;
+   const int EARTH_RADIUS = 6371000;
+
    double ComputeDistance(Coordinates from, Coordinates to) {
+       if (from == to) {
+           return 0;
+       }
+       return ComputeDistance(from, ComputeLatitudeTrig(from), to, ComputeLatitudeTrig(to));
+   }
+
+   LatitudeTrig ComputeLatitudeTrig(Coordinates coordinates) {
+       return { std::sin(coordinates.lat * DR), std::cos(coordinates.lat * DR) };
+   }
+
+   double ComputeDistance(Coordinates from, const LatitudeTrig& from_trig,
+       Coordinates to, const LatitudeTrig& to_trig)
+   {
        using namespace std;
        if (from == to) {
            return 0;
        }
-       static const double dr = 3.1415926535 / 180.;
-       static const int earth_radius = 6371000;
-       return acos(sin(from.lat * dr) * sin(to.lat * dr)
-           + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-           * earth_radius;
+       return acos(from_trig.sin_lat * to_trig.sin_lat
+           + from_trig.cos_lat * to_trig.cos_lat * cos(abs(from.lng - to.lng) * DR))
+           * EARTH_RADIUS;
    }
 
    bool Coordinates::operator==(const Coordinates& other) const {
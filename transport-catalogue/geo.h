@@ -15,6 +15,20 @@ namespace geo {
 
     double ComputeDistance(Coordinates from, Coordinates to);
 
+    // Синус и косинус широты точки, вычисленные заранее для ComputeDistance
+    struct LatitudeTrig {
+        double sin_lat = 0.0;
+        double cos_lat = 0.0;
+    };
+
+    LatitudeTrig ComputeLatitudeTrig(Coordinates coordinates);
+
+    // То же, что ComputeDistance(from, to), но синусы и косинусы широт берутся из from_trig и to_trig,
+    // и вычисляется только косинус разности долгот. Формула и порядок операций те же, поэтому
+    // результат совпадает с ComputeDistance побитово и ответы, зависящие от расстояний, не меняются
+    double ComputeDistance(Coordinates from, const LatitudeTrig& from_trig,
+        Coordinates to, const LatitudeTrig& to_trig);
+
     struct CoordinatesHash {
         std::size_t operator()(const Coordinates& coordinate) const;
     };
@@ -26,7 +26,9 @@ private:
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    VertexId AddVertex();
     EdgeId AddEdge(const Edge<Weight>& edge);
+    void SetEdgeWeight(EdgeId edge_id, const Weight& weight);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
@@ -43,6 +45,12 @@ DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
     : incidence_lists_(vertex_count) {
 }
 
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::AddVertex() {
+    incidence_lists_.emplace_back();
+    return incidence_lists_.size() - 1;
+}
+
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     edges_.push_back(edge);
@@ -51,6 +59,11 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, const Weight& weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
     return incidence_lists_.size();
@@ -1,5 +1,14 @@
 #include "json.h"
 
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace json {
@@ -332,31 +341,82 @@ namespace json {
         ctx.out << value;
     }
 
-    void PrintString(const std::string& value, std::ostream& out) {
-        out.put('"');
-        for (const char c : value) {
-            switch (c) {
-            case '\r':
-                out << "\\r"sv;
-                break;
-            case '\n':
-                out << "\\n"sv;
-                break;
-            case '\t':
-                out << "\\t"sv;
-                break;
-            case '"':
-                // Символы " и \ выводятся как \" или \\, соответственно
-                [[fallthrough]];
-            case '\\':
-                out.put('\\');
-                [[fallthrough]];
-            default:
-                out.put(c);
+    namespace {
+
+        // Символы, которые выводятся в строках экранированными: \r, \n, \t, кавычка и обратная косая черта
+        constexpr std::array<bool, 256> ESCAPED_CHARS = [] {
+            std::array<bool, 256> result{};
+            for (const char c : "\r\n\t\"\\"sv) {
+                result[static_cast<unsigned char>(c)] = true;
+            }
+            return result;
+        }();
+
+        // Возвращает первый экранируемый символ в [pos, end) или end. Строка просматривается
+        // блоками по 16 символов (SSE2, если доступно), остаток - по таблице ESCAPED_CHARS
+        const char* FindEscapedChar(const char* pos, const char* end) {
+#ifdef __SSE2__
+            const __m128i carriage_return = _mm_set1_epi8('\r');
+            const __m128i line_feed = _mm_set1_epi8('\n');
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            for (; end - pos >= 16; pos += 16) {
+                const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+                const __m128i matches = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chars, carriage_return), _mm_cmpeq_epi8(chars, line_feed)),
+                    _mm_or_si128(_mm_cmpeq_epi8(chars, tab),
+                        _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash))));
+                if (const int mask = _mm_movemask_epi8(matches); mask != 0) {
+                    return pos + std::countr_zero(static_cast<unsigned>(mask));
+                }
+            }
+#endif
+            while (pos != end && !ESCAPED_CHARS[static_cast<unsigned char>(*pos)]) {
+                ++pos;
+            }
+            return pos;
+        }
+
+    }  // namespace
+
+    // Выводит строку в кавычках. Участки без экранируемых символов копируются целиком
+    // в буфер на стеке, который выводится в поток одним вызовом write по заполнении
+    // (участки длиннее буфера выводятся сразу), поэтому строка любой длины не требует
+    // выделения памяти и посимвольного вывода
+    void PrintString(std::string_view value, std::ostream& out) {
+        std::array<char, 4096> buffer;
+        size_t size = 0;
+        auto append = [&](const char* data, size_t count) {
+            if (size + count > buffer.size()) {
+                out.write(buffer.data(), size);
+                size = 0;
+                if (count > buffer.size()) {
+                    out.write(data, count);
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + size, data, count);
+            size += count;
+        };
+
+        append("\"", 1);
+        const char* pos = value.data();
+        const char* const end = pos + value.size();
+        while (true) {
+            const char* escaped = FindEscapedChar(pos, end);
+            append(pos, escaped - pos);
+            if (escaped == end) {
                 break;
             }
+            // Символы " и \ выводятся как \" или \\, управляющие - как \r, \n и \t
+            const char sequence[2] = { '\\',
+                (*escaped == '\r') ? 'r' : (*escaped == '\n') ? 'n' : (*escaped == '\t') ? 't' : *escaped };
+            append(sequence, 2);
+            pos = escaped + 1;
         }
-        out.put('"');
+        append("\"", 1);
+        out.write(buffer.data(), size);
     }
 
     template <>
@@ -34,11 +34,11 @@ namespace json {
 	
 	// BaseBuilder
 	
-	Builder& Builder::BaseBuilder::Value(Builder& builder, Node::Value value) {
+	Builder& Builder::BaseBuilder::Value(Builder& builder, Node::Value&& value) {
 		if (builder.root_.has_value()) {
 			throw std::logic_error("Twice build"s);
 		}
-		builder.root_ = GetNode(value);
+		builder.root_ = GetNode(move(value));
 		return builder;
 	}
 	
@@ -60,15 +60,18 @@ namespace json {
 		if (!builder.root_.has_value()) {
 			throw std::logic_error("Nothing to build"s);
 		}
-		return builder.root_.value();
+		// Корень забирается из построителя, повторный Build выбросит исключение
+		Node result = move(*builder.root_);
+		builder.root_.reset();
+		return result;
 	}
 
 	// ------------------------------------------------------------------------
 	
 	// ArrayBuilder
 
-	Builder& Builder::ArrayBuilder::Value(Builder& builder, Node::Value value) {
-		arr_.push_back(GetNode(value));
+	Builder& Builder::ArrayBuilder::Value(Builder& builder, Node::Value&& value) {
+		arr_.push_back(GetNode(move(value)));
 		return builder;
 	}
 
@@ -95,7 +98,7 @@ namespace json {
 	}
 
 	Node::Value Builder::ArrayBuilder::GetValue() {
-		return arr_;
+		return move(arr_);
 	}
 	
 	// ------------------------------------------------------------------------
@@ -106,8 +109,8 @@ namespace json {
 		key_ = move(key);
 		return builder;
 	}
-	Builder& Builder::DictBuilder::Value(Builder& builder, Node::Value value) {
-		dict_.insert({key_, GetNode(value)});
+	Builder& Builder::DictBuilder::Value(Builder& builder, Node::Value&& value) {
+		dict_.insert({key_, GetNode(move(value))});
 		return builder;
 	}
 
@@ -134,7 +137,7 @@ namespace json {
 	}
 
 	Node::Value Builder::DictBuilder::GetValue() {
-		return dict_;
+		return move(dict_);
 	}
 
 	// ---------------------------------------------------------
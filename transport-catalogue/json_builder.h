@@ -39,7 +39,7 @@ namespace json {
 			return DictValueContext{ builder_->Key(*this, key) }; 
 		}
 		BaseContext Value(Node::Value value) {
-			return BaseContext{ builder_->Value(*this, value) };
+			return BaseContext{ builder_->Value(*this, std::move(value)) };
 		}
 		DictItemContext StartDict() {
 			return BaseContext{ builder_->StartDict(*this) };
@@ -74,7 +74,7 @@ namespace json {
 			virtual Builder& Key(Builder& builder, std::string) {
 				return builder;
 			}
-			virtual Builder& Value(Builder& builder, Node::Value value);
+			virtual Builder& Value(Builder& builder, Node::Value&& value);
 
 			// Ничего не делает, служит для переопределения в DictBuilder
 			virtual Builder& EndDict(Builder& builder) {
@@ -87,7 +87,9 @@ namespace json {
 			}
 			virtual Builder& StartDict(Builder& builder);
 			virtual Builder& StartArray(Builder& builder);
+			// Отдает построенное значение, после этого строитель больше не используется
 			virtual Node::Value GetValue();
+			// Отдает построенный узел (строки и контейнеры перемещаются, а не копируются)
 			virtual Node Build(Builder& builder);
 		};
 
@@ -98,7 +100,7 @@ namespace json {
 			~DictBuilder() override = default;
 
 			Builder& Key(Builder& builder, std::string key) override;
-			Builder& Value(Builder& builder, Node::Value value) override;
+			Builder& Value(Builder& builder, Node::Value&& value) override;
 			Builder& EndDict(Builder& builder) override;
 			Builder& StartDict(Builder& builder) override;
 			Builder& StartArray(Builder& builder) override;
@@ -115,7 +117,7 @@ namespace json {
 
 			~ArrayBuilder() override = default;
 
-			Builder& Value(Builder& builder, Node::Value value) override;
+			Builder& Value(Builder& builder, Node::Value&& value) override;
 			Builder& EndArray(Builder& builder) override;
 			Builder& StartDict(Builder& builder) override;
 			Builder& StartArray(Builder& builder) override;
@@ -138,8 +140,9 @@ namespace json {
 			DictValueContext Key(std::string key) {
 				return builder_.Key(key);
 			}
+			// Значение перемещается прямо в текущий строитель
 			BaseContext Value(Node::Value value) { 
-				return builder_.Value(value);
+				return builder_.builder_->Value(builder_, std::move(value));
 			}
 			DictItemContext StartDict() {
 				return builder_.StartDict();
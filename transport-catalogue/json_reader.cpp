@@ -1,9 +1,11 @@
 #include "json_reader.h"
+#include "compression.h"
 #include "json_builder.h"
 #include "transport_router.h"
 
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 namespace reader {
 
@@ -70,7 +72,7 @@ namespace reader {
 					bus_stops.push_back(catalogue.GetStop(iter->AsString()));
 				}
 			}
-			catalogue.AddBus({ map_request.at("name"s).AsString(), std::move(bus_stops), is_round });
+			catalogue.AddBus({ map_request.at("name"s).AsString(), bus_stops, is_round });
 		}
 	}
 
@@ -82,11 +84,11 @@ namespace reader {
 		AddBuses(base_requests, catalogue, commands.second);
 	}
 
-	json::Node ErrorNode(const json::Dict& request) {
+	json::Node ErrorNode(const json::Dict& request, std::string message = "not found"s) {
 		return json::Builder{}
 					.StartDict()
 					.Key("request_id"s).Value(request.at("id"s).AsInt())
-					.Key("error_message"s).Value("not found"s)
+					.Key("error_message"s).Value(std::move(message))
 					.EndDict()
 					.Build();
 	}
@@ -116,7 +118,7 @@ namespace reader {
 		const auto& name = request.at("name"s).AsString();
 
 		if (const auto info = handler.GetStopInformation(name)) {
-			const auto info_value = info.value();
+			const auto& info_value = info.value();
 			json::Array info_vector;
 			info_vector.reserve(info_value.size());
 			for (const auto bus : info_value) {
@@ -133,22 +135,42 @@ namespace reader {
 			return ErrorNode(request);
 		}
 	}
+
+	// Возвращает ответ с картой map. Если в запросе указана кодировка "gzip_base64",
+	// карта сжимается в gzip и кодируется в base64, а кодировка повторяется в ответе.
+	// На неизвестную кодировку возвращается ошибка, остальные запросы обрабатываются как обычно
+	json::Node GetMapAnswer(const json::Dict& request, std::string map) {
+		const auto encoding = request.find("encoding"s);
+		if (encoding == request.end() || (encoding->second.IsString() && encoding->second.AsString() == "plain"s)) {
+			return json::Builder{}
+						.StartDict()
+						.Key("request_id"s).Value(request.at("id"s).AsInt())
+						.Key("map"s).Value(std::move(map))
+						.EndDict()
+						.Build();
+		}
+		if (!encoding->second.IsString() || encoding->second.AsString() != "gzip_base64"s) {
+			return ErrorNode(request, "unknown encoding"s);
+		}
+		return json::Builder{}
+					.StartDict()
+					.Key("request_id"s).Value(request.at("id"s).AsInt())
+					.Key("encoding"s).Value("gzip_base64"s)
+					.Key("map"s).Value(compression::EncodeBase64(compression::Gzip(map)))
+					.EndDict()
+					.Build();
+	}
+
 	// Возвращает словарь с информацией по запросу "Map"
 	json::Node GetMapInfo(const json::Dict& request, const handler::RequestHandler& handler) {
 
-		svg::Document doc = handler.RenderMap();
-
 		// Буфер для вывода карты маршрутов
 		std::ostringstream buffer;
 
-		doc.Render(buffer);
+		handler.RenderMap(buffer);
 		
-		return json::Builder{}
-					.StartDict()
-					.Key("request_id"s).Value(request.at("id"s).AsInt())
-					.Key("map"s).Value(buffer.str())
-					.EndDict()
-					.Build();
+		// Строка буфера забирается без копирования
+		return GetMapAnswer(request, std::move(buffer).str());
 	}
 
 	json::Array GetRouteItems(const router::RouterInformation& info) {
@@ -164,6 +186,16 @@ namespace reader {
 					.Build()
 				);
 			}
+			else if (item.type == router::RouteType::WALK) {
+				result.push_back(json::Builder{}
+					.StartDict()
+					.Key("type"s).Value("Walk"s)
+					.Key("time"s).Value(item.time)
+					.Key("stop_name"s).Value(std::string(item.data))
+					.EndDict()
+					.Build()
+				);
+			}
 			else {
 				result.push_back(json::Builder{}
 					.StartDict()
@@ -182,10 +214,12 @@ namespace reader {
 	// Возвращает словарь с информацией по запросу "Route"
 	json::Node GetRouteInfo(const json::Dict& request, const handler::RequestHandler& handler) {
 
-		const auto& from = request.at("from"s).AsString();
-		const auto& to = request.at("to"s).AsString();
-
-		const auto info = handler.GetRouterInfo(from, to);
+		// Начало и конец маршрута задаются названиями остановок или координатами точек
+		const auto info = (request.find("from"s) != request.end())
+			? handler.GetRouterInfo(request.at("from"s).AsString(), request.at("to"s).AsString())
+			: handler.GetRouterInfo(
+				geo::Coordinates{ request.at("from_latitude"s).AsDouble(), request.at("from_longitude"s).AsDouble() },
+				geo::Coordinates{ request.at("to_latitude"s).AsDouble(), request.at("to_longitude"s).AsDouble() });
 
 		if (info.has_value()) {
 			const auto info_value = info.value();
@@ -203,6 +237,125 @@ namespace reader {
 		}
 	}
 
+	// Возвращает словарь с информацией по запросу "Isochrone"
+	json::Node GetIsochroneInfo(const json::Dict& request, const handler::RequestHandler& handler) {
+
+		const auto& from = request.at("from"s).AsString();
+		const double max_time = request.at("max_time"s).AsDouble();
+
+		const auto info = handler.GetReachableStops(from, max_time);
+
+		if (info.has_value()) {
+			json::Array stops;
+			stops.reserve(info->size());
+			for (const auto& stop : info.value()) {
+				stops.push_back(json::Builder{}
+					.StartDict()
+					.Key("stop_name"s).Value(std::string(stop.stop_name))
+					.Key("time"s).Value(stop.time)
+					.EndDict()
+					.Build()
+				);
+			}
+
+			return json::Builder{}
+				.StartDict()
+				.Key("request_id"s).Value(request.at("id"s).AsInt())
+				.Key("stops"s).Value(std::move(stops))
+				.EndDict()
+				.Build();
+		}
+		else {
+			return ErrorNode(request);
+		}
+	}
+
+	// Возвращает словарь с остановками и расстояниями до них (ответ на запросы "NearestStops" и "StopsInRadius")
+	json::Node GetStopsDistancesInfo(const json::Dict& request,
+		const std::vector<transport_catalogue::detail::StopDistance>& stops_distances) {
+
+		json::Array stops;
+		stops.reserve(stops_distances.size());
+		for (const auto& [stop, distance] : stops_distances) {
+			stops.push_back(json::Builder{}
+				.StartDict()
+				.Key("distance"s).Value(distance)
+				.Key("stop_name"s).Value(std::string(stop->name))
+				.EndDict()
+				.Build()
+			);
+		}
+
+		return json::Builder{}
+			.StartDict()
+			.Key("request_id"s).Value(request.at("id"s).AsInt())
+			.Key("stops"s).Value(std::move(stops))
+			.EndDict()
+			.Build();
+	}
+
+	// Возвращает координаты из ключей lat_key и lng_key запроса
+	geo::Coordinates GetCoordinates(const json::Dict& request, const std::string& lat_key, const std::string& lng_key) {
+		return { request.at(lat_key).AsDouble(), request.at(lng_key).AsDouble() };
+	}
+
+	// Возвращает словарь с информацией по запросу "NearestStops"
+	json::Node GetNearestStopsInfo(const json::Dict& request, const handler::RequestHandler& handler) {
+		const int count = request.at("count"s).AsInt();
+		return GetStopsDistancesInfo(request, handler.GetNearestStops(
+			GetCoordinates(request, "latitude"s, "longitude"s), static_cast<size_t>(std::max(count, 0))));
+	}
+
+	// Возвращает словарь с информацией по запросу "StopsInRadius"
+	json::Node GetStopsInRadiusInfo(const json::Dict& request, const handler::RequestHandler& handler) {
+		return GetStopsDistancesInfo(request, handler.GetStopsWithinRadius(
+			GetCoordinates(request, "latitude"s, "longitude"s), request.at("radius"s).AsDouble()));
+	}
+
+	// Возвращает словарь с информацией по запросу "StopsInBox"
+	json::Node GetStopsInBoxInfo(const json::Dict& request, const handler::RequestHandler& handler) {
+		const auto stops = handler.GetStopsInBox(GetCoordinates(request, "min_latitude"s, "min_longitude"s),
+			GetCoordinates(request, "max_latitude"s, "max_longitude"s));
+
+		json::Array stop_names;
+		stop_names.reserve(stops.size());
+		for (const auto stop : stops) {
+			stop_names.emplace_back(std::string(stop->name));
+		}
+
+		return json::Builder{}
+			.StartDict()
+			.Key("request_id"s).Value(request.at("id"s).AsInt())
+			.Key("stops"s).Value(std::move(stop_names))
+			.EndDict()
+			.Build();
+	}
+
+	// Возвращает словарь с информацией по запросу "MapTile"
+	json::Node GetMapTileInfo(const json::Dict& request, const handler::RequestHandler& handler) {
+
+		// Часть карты задается тайлом zoom/x/y или прямоугольником координат
+		renderer::MapArea area;
+		if (request.find("zoom"s) != request.end()) {
+			const renderer::MapTile tile{ request.at("zoom"s).AsInt(), request.at("x"s).AsInt(), request.at("y"s).AsInt() };
+			if (!renderer::IsValidTile(tile)) {
+				return ErrorNode(request, "invalid tile"s);
+			}
+			area = tile;
+		}
+		else {
+			area = renderer::MapBox{ GetCoordinates(request, "min_latitude"s, "min_longitude"s),
+				GetCoordinates(request, "max_latitude"s, "max_longitude"s) };
+		}
+
+		// Буфер для вывода части карты
+		std::ostringstream buffer;
+
+		handler.RenderMap(area, buffer);
+
+		return GetMapAnswer(request, std::move(buffer).str());
+	}
+
 	json::Document JsonReader::GetInfo(const handler::RequestHandler& handler) {
 
 		const auto& stat_requests = document_.GetRoot().AsMap().at("stat_requests"s).AsArray();
@@ -225,6 +378,21 @@ namespace reader {
 			else if (type == "Route"s) {
 				result.emplace_back(std::move(GetRouteInfo(map_request, handler)));
 			}
+			else if (type == "Isochrone"s) {
+				result.emplace_back(std::move(GetIsochroneInfo(map_request, handler)));
+			}
+			else if (type == "NearestStops"s) {
+				result.emplace_back(std::move(GetNearestStopsInfo(map_request, handler)));
+			}
+			else if (type == "StopsInRadius"s) {
+				result.emplace_back(std::move(GetStopsInRadiusInfo(map_request, handler)));
+			}
+			else if (type == "StopsInBox"s) {
+				result.emplace_back(std::move(GetStopsInBoxInfo(map_request, handler)));
+			}
+			else if (type == "MapTile"s) {
+				result.emplace_back(std::move(GetMapTileInfo(map_request, handler)));
+			}
 		}
 		return json::Document(std::move(result));
 	}
@@ -283,6 +451,76 @@ namespace reader {
 			settings.color_palette.push_back(GetColor(color));
 		}
 
+		if (const auto tolerance = render_settings.find("polyline_tolerance"s); tolerance != render_settings.end()) {
+			settings.polyline_tolerance = tolerance->second.AsDouble();
+		}
+
+		return settings;
+	}
+
+	router::RoutingSettings JsonReader::GetRoutingSettings() const {
+		const auto& routing_settings = document_.GetRoot().AsMap().at("routing_settings"s).AsMap();
+
+		router::RoutingSettings settings;
+
+		if (const auto mode = routing_settings.find("routing_mode"s); mode != routing_settings.end()) {
+			const auto& mode_name = mode->second.AsString();
+			if (mode_name == "all_pairs"s) {
+				settings.mode = router::RouterMode::ALL_PAIRS;
+			}
+			else if (mode_name == "a_star"s) {
+				settings.mode = router::RouterMode::A_STAR;
+			}
+			else if (mode_name == "alt"s) {
+				settings.mode = router::RouterMode::ALT;
+			}
+			else if (mode_name == "raptor"s) {
+				settings.mode = router::RouterMode::RAPTOR;
+			}
+			else {
+				throw std::invalid_argument("Unknown routing mode: "s + mode_name);
+			}
+		}
+
+		if (const auto landmarks_count = routing_settings.find("landmarks_count"s);
+			landmarks_count != routing_settings.end()) {
+			settings.landmarks_count = static_cast<size_t>(landmarks_count->second.AsInt());
+		}
+
+		if (const auto walking_velocity = routing_settings.find("walking_velocity"s);
+			walking_velocity != routing_settings.end()) {
+			settings.walking_velocity = walking_velocity->second.AsDouble();
+		}
+
+		if (const auto walk_stops_count = routing_settings.find("walk_stops_count"s);
+			walk_stops_count != routing_settings.end()) {
+			settings.walk_stops_count = static_cast<size_t>(walk_stops_count->second.AsInt());
+		}
+
+		return settings;
+	}
+
+	OutputSettings JsonReader::GetOutputSettings() const {
+		const auto& root = document_.GetRoot().AsMap();
+
+		OutputSettings settings;
+
+		const auto output_settings = root.find("output_settings"s);
+		if (output_settings == root.end()) {
+			return settings;
+		}
+
+		if (const auto compression = output_settings->second.AsMap().find("svg_compression"s);
+			compression != output_settings->second.AsMap().end()) {
+			const auto& compression_name = compression->second.AsString();
+			if (compression_name == "gzip"s) {
+				settings.compress_svg = true;
+			}
+			else if (compression_name != "none"s) {
+				throw std::invalid_argument("Unknown SVG compression: "s + compression_name);
+			}
+		}
+
 		return settings;
 	}
 
@@ -6,6 +6,12 @@
 
 namespace reader {
 
+    // Настройки вывода результатов
+    struct OutputSettings {
+        // Записывать карту сжатой в формате gzip (файл out_image.svg.gz вместо out_image.svg)
+        bool compress_svg = false;
+    };
+
     class JsonReader {
     public:
 
@@ -23,6 +29,12 @@ namespace reader {
         // Возвращает MapRendererSettings из словаря "render_settings"
         renderer::MapRendererSettings GetRenderSettings() const;
 
+        // Возвращает RoutingSettings из словаря "routing_settings"
+        router::RoutingSettings GetRoutingSettings() const;
+
+        // Возвращает OutputSettings из необязательного словаря "output_settings"
+        OutputSettings GetOutputSettings() const;
+
     private:
 
         json::Document document_;
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <fstream>
 
+#include "compression.h"
 #include "json_reader.h"
 
 using namespace std;
@@ -13,16 +14,16 @@ int main() {
     reader::JsonReader reader(cin);
 
     reader.AddBaseRequests(catalogue);
+    catalogue.Finalize();
     reader.AddRoutingSettings(catalogue);
 
     renderer::MapRenderer renderer(reader.GetRenderSettings());
-    router::TransportRoute route(catalogue);
+    router::TransportRoute route(catalogue, reader.GetRoutingSettings());
 
     handler::RequestHandler handler(catalogue, renderer, route);
 
     const auto doc_json = reader.GetInfo(handler);
-
-    svg::Document doc_svg = handler.RenderMap();
+    const auto output_settings = reader.GetOutputSettings();
 
     ofstream out_json("out.json"s);
 
@@ -33,13 +34,22 @@ int main() {
         json::Print(doc_json, out_json);
     }
 
-    ofstream out_svg("out_image.svg"s);
+    //      
+    ofstream out_svg(output_settings.compress_svg ? "out_image.svg.gz"s : "out_image.svg"s,
+        output_settings.compress_svg ? ios::out | ios::binary : ios::out);
 
     if (!out_svg) {
         cerr << "   'out.json'  "s << endl;
     }
+    else if (output_settings.compress_svg) {
+        //     ,      
+        compression::GzipStreamBuf gzip_buffer(out_svg);
+        ostream gzip_out(&gzip_buffer);
+        handler.RenderMap(gzip_out);
+        gzip_buffer.Finish();
+    }
     else {
-        doc_svg.Render(out_svg);
+        handler.RenderMap(out_svg);
     }
 
 }
\ No newline at end of file
@@ -1,95 +1,260 @@
 #include "map_renderer.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace renderer {
 
 	using namespace std::literals;
 
-	const std::vector<geo::Coordinates> MapRenderer::GetAllCoordinates(const StopsContainer& stops) const {
-		
-		std::vector<geo::Coordinates> result;
-		result.reserve(stops.size());
-		for (const auto& stop : stops) {
-			result.push_back(stop->coordinates);
+	StopsProjection::StopsProjection(const SphereProjector& projector, const StopsContainer& stops)
+		: projector_(projector)
+	{
+		uint32_t max_id = 0;
+		for (const auto stop : stops) {
+			max_id = std::max(max_id, stop->id);
+		}
+		points_.resize(stops.empty() ? 0 : max_id + 1);
+		for (const auto stop : stops) {
+			points_[stop->id] = projector_(stop->coordinates);
 		}
-
-		return result;
 	}
 
 	const SphereProjector MapRenderer::CreateProjector(const StopsContainer& stops) const{
 
-		// Точки, подлежащие проецированию
-		const auto coordinates = GetAllCoordinates(stops);
+		// Крайние координаты остановок: проектору достаточно их
+		std::vector<geo::Coordinates> corners;
+		if (!stops.empty()) {
+			geo::Coordinates min_corner = stops.front()->coordinates;
+			geo::Coordinates max_corner = stops.front()->coordinates;
+			for (const auto stop : stops) {
+				min_corner.lat = std::min(min_corner.lat, stop->coordinates.lat);
+				min_corner.lng = std::min(min_corner.lng, stop->coordinates.lng);
+				max_corner.lat = std::max(max_corner.lat, stop->coordinates.lat);
+				max_corner.lng = std::max(max_corner.lng, stop->coordinates.lng);
+			}
+			corners = { min_corner, max_corner };
+		}
 
 		return {
-			coordinates.begin(), coordinates.end(),
+			corners.begin(), corners.end(),
 			settings_.width, settings_.height, settings_.padding
 		};
 	}
 
-	const svg::Polyline MapRenderer::GetPolylineRoute(const domain::Bus* bus, const SphereProjector& projector) const {
-		svg::Polyline polyline;
+	const StopsProjection& MapRenderer::GetProjection(const StopsContainer& stops, uint64_t revision) const {
+		if (projection_ && projection_revision_ == revision) {
+			return *projection_;
+		}
+
+		// Если новые остановки не сдвинули границы карты, прежние точки и фрагменты остаются верными
+		const SphereProjector projector = CreateProjector(stops);
+		if (!projection_ || projection_->GetProjector() != projector) {
+			bus_fragments_.clear();
+			stop_fragments_.clear();
+		}
+		projection_.emplace(projector, stops);
+		projection_revision_ = revision;
+		return *projection_;
+	}
+
+	const std::vector<size_t>& MapRenderer::GetColorIndexes(const BusesContainer& buses, uint64_t revision) const {
+		if (color_indexes_revision_ == revision) {
+			return color_indexes_;
+		}
+
+		// Цвет палитры меняется после каждого непустого маршрута
+		uint32_t max_id = 0;
+		for (const auto bus : buses) {
+			max_id = std::max(max_id, bus->id);
+		}
+		color_indexes_.assign(buses.empty() ? 0 : max_id + 1, 0);
+		const size_t palette_size = std::max<size_t>(settings_.color_palette.size(), 1);
+		size_t color_index = 0;
+		for (const auto bus : buses) {
+			color_indexes_[bus->id] = color_index;
+			if (!bus->bus_stops.empty()) {
+				color_index = (color_index + 1 == palette_size) ? 0 : color_index + 1;
+			}
+		}
+		color_indexes_revision_ = revision;
+		return color_indexes_;
+	}
+
+	bool IsValidTile(const MapTile& tile) {
+		return tile.zoom >= 0 && tile.zoom <= MAX_TILE_ZOOM
+			&& tile.x >= 0 && tile.x < (1 << tile.zoom) && tile.y >= 0 && tile.y < (1 << tile.zoom);
+	}
+
+	namespace {
+
+		// Квадрат расстояния от точки point до отрезка [from, to]
+		double SquaredDistanceToSegment(svg::Point point, svg::Point from, svg::Point to) {
+			const double dx = to.x - from.x;
+			const double dy = to.y - from.y;
+			const double squared_length = dx * dx + dy * dy;
+			double t = 0.0;
+			if (squared_length > 0.0) {
+				t = std::clamp(((point.x - from.x) * dx + (point.y - from.y) * dy) / squared_length, 0.0, 1.0);
+			}
+			const double x = from.x + t * dx - point.x;
+			const double y = from.y + t * dy - point.y;
+			return x * x + y * y;
+		}
+
+		// Отбрасывает вершины ближе tolerance к предыдущей оставленной (последняя вершина остается всегда)
+		std::vector<svg::Point> DropClosePoints(const std::vector<svg::Point>& points, double tolerance) {
+			std::vector<svg::Point> result;
+			result.reserve(points.size());
+			for (size_t i = 0; i < points.size(); ++i) {
+				if (!result.empty() && SquaredDistanceToSegment(points[i], result.back(), result.back()) <= tolerance * tolerance) {
+					if (i + 1 != points.size()) {
+						continue;
+					}
+					if (result.size() > 1) {
+						result.pop_back();
+					}
+				}
+				result.push_back(points[i]);
+			}
+			return result;
+		}
+
+		// Упрощает ломаную алгоритмом Дугласа - Пекера: остаются вершины, без которых ломаная
+		// отклонилась бы больше чем на tolerance. Расстояние считается до отрезка, а не до прямой,
+		// чтобы не терять разворот маршрута, идущего туда и обратно
+		std::vector<svg::Point> SimplifyPolyline(const std::vector<svg::Point>& points, double tolerance) {
+			if (points.size() <= 2) {
+				return points;
+			}
+			std::vector<bool> is_kept(points.size(), false);
+			is_kept.front() = is_kept.back() = true;
+
+			std::vector<std::pair<size_t, size_t>> ranges{ { 0, points.size() - 1 } };
+			while (!ranges.empty()) {
+				const auto [first, last] = ranges.back();
+				ranges.pop_back();
+
+				size_t farthest = first;
+				double max_distance = tolerance * tolerance;
+				for (size_t i = first + 1; i < last; ++i) {
+					const double distance = SquaredDistanceToSegment(points[i], points[first], points[last]);
+					if (distance > max_distance) {
+						max_distance = distance;
+						farthest = i;
+					}
+				}
+				if (farthest != first) {
+					is_kept[farthest] = true;
+					ranges.push_back({ first, farthest });
+					ranges.push_back({ farthest, last });
+				}
+			}
+
+			std::vector<svg::Point> result;
+			for (size_t i = 0; i < points.size(); ++i) {
+				if (is_kept[i]) {
+					result.push_back(points[i]);
+				}
+			}
+			return result;
+		}
+
+	} // namespace
+
+	const svg::Polyline MapRenderer::GetPolylineRoute(const domain::Bus* bus, const StopsProjection& projection) const {
+		std::vector<svg::Point> points;
+		points.reserve(bus->bus_stops.size());
 		for (const auto& bus_stop : bus->bus_stops) {
-			polyline.AddPoint(projector(bus_stop->coordinates));
+			points.push_back(projection(bus_stop));
+		}
+
+		if (settings_.polyline_tolerance > 0) {
+			points = SimplifyPolyline(DropClosePoints(points, settings_.polyline_tolerance), settings_.polyline_tolerance);
+		}
+
+		svg::Polyline polyline;
+		for (const auto& point : points) {
+			polyline.AddPoint(point);
 		}
 		return polyline;
 	}
 
-	void MapRenderer::RenderLines(const BusesContainer& buses, const SphereProjector& projector, svg::Document& doc) const {
+	MapRenderer::LayersAttrs MapRenderer::GetLayersAttrs(std::optional<std::streamsize> precision) const {
+		auto make_attrs = [precision](svg::PathAttrs attrs) {
+			std::string formatted = (precision) ? svg::FormatPathAttrs(attrs, *precision) : std::string{};
+			return ObjectAttrs{ std::move(attrs), std::move(formatted) };
+		};
 
-		// Итератор ссылающийся на цвет линии маршрута
-		auto color_iter = settings_.color_palette.begin();
+		LayersAttrs result;
+		for (const auto& color : settings_.color_palette) {
+			result.lines.push_back(make_attrs({
+				.fill_color = svg::NoneColor,
+				.stroke_color = color,
+				.stroke_width = settings_.line_width,
+				.stroke_linecap = svg::StrokeLineCap::ROUND,
+				.stroke_linejoin = svg::StrokeLineJoin::ROUND }));
+			result.bus_labels.push_back(make_attrs({ .fill_color = color }));
+		}
+		result.underlayer = make_attrs({
+			.fill_color = settings_.underlayer_color,
+			.stroke_color = settings_.underlayer_color,
+			.stroke_width = settings_.underlayer_width,
+			.stroke_linecap = svg::StrokeLineCap::ROUND,
+			.stroke_linejoin = svg::StrokeLineJoin::ROUND });
+		result.stop_symbols = make_attrs({ .fill_color = svg::Color("white"s) });
+		result.stop_labels = make_attrs({ .fill_color = svg::Color("black"s) });
+		return result;
+	}
 
+	void MapRenderer::RenderLines(const BusesContainer& buses, const StopsProjection& projection,
+		svg::ObjectContainer& container, const LayersAttrs& attrs, size_t color_index) const
+	{
 		// Отрисовываем маршруты
 		for (const auto& bus : buses) {
 
 			if (bus->bus_stops.empty()) {
 				continue;
 			}
-			svg::Polyline polyline = GetPolylineRoute(bus, projector);
+			svg::Polyline polyline = GetPolylineRoute(bus, projection);
 
-			// Добавляем Polyline в Document с настройками из settings_
-			doc.Add(polyline.SetStrokeColor(*color_iter)
-				.SetFillColor(svg::NoneColor)
-				.SetStrokeWidth(settings_.line_width)
-				.SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-				.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
+			// Добавляем Polyline в Document с атрибутами цвета линии маршрута
+			container.Add(std::move(SetAttrs(polyline, attrs.lines[color_index])));
 
-			(color_iter + 1 == settings_.color_palette.end()) ? color_iter = settings_.color_palette.begin() : ++color_iter;
+			color_index = (color_index + 1 == attrs.lines.size()) ? 0 : color_index + 1;
 		}
 	}
 
-	const svg::Text MapRenderer::GetBusBaseText(const std::string& name) const {
+	const svg::Text MapRenderer::GetBusBaseText(std::string_view name) const {
 		return svg::Text().SetOffset(settings_.bus_label_offset)
 						.SetFontSize(settings_.bus_label_font_size)
 						.SetFontFamily("Verdana"s)
 						.SetFontWeight("bold"s)
-						.SetData(name);
+						.SetData(std::string(name));
 	}
 
-	void MapRenderer::AddText(const svg::Text& base_text, svg::Document& doc, const svg::Color& color,
-		const svg::Point& point) const
+	void MapRenderer::AddText(svg::Text base_text, svg::ObjectContainer& container, const ObjectAttrs& text_attrs,
+		const ObjectAttrs& underlayer_attrs, const svg::Point& point) const
 	{
 
 		// Добавляем подложку
-		doc.Add(svg::Text{ base_text }.SetPosition(point)
-									.SetFillColor(settings_.underlayer_color)
-									.SetStrokeColor(settings_.underlayer_color)
-									.SetStrokeWidth(settings_.underlayer_width)
-									.SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-									.SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
+		svg::Text underlayer{ base_text };
+		container.Add(std::move(SetAttrs(underlayer.SetPosition(point), underlayer_attrs)));
 
 		// Добавляем основную надпись
-		doc.Add(svg::Text{ base_text }.SetPosition(point)
-									.SetFillColor(color));
+		container.Add(std::move(SetAttrs(base_text.SetPosition(point), text_attrs)));
 	}
 
-	void MapRenderer::RenderBusText(const BusesContainer& buses, const SphereProjector& projector, svg::Document& doc) const {
-
-		// Итератор ссылающийся на цвет линии маршрута
-		auto color_iter = settings_.color_palette.begin();
-
+	void MapRenderer::RenderBusText(const BusesContainer& buses, const StopsProjection& projection,
+		svg::ObjectContainer& container, const LayersAttrs& attrs, size_t color_index) const
+	{
 		// Отрисовываем названия маршрутов
 		for (const auto& bus : buses) {
 
@@ -101,36 +266,42 @@ namespace renderer {
 			svg::Text bus_name_text = GetBusBaseText(bus->name);
 
 			// Добавляем название маршрута в координаты конечной остановки
-			AddText(bus_name_text, doc, *color_iter, projector(bus->bus_stops[0]->coordinates));
+			// (у кольцевого маршрута текст больше не понадобится и передается без копирования)
+			const ObjectAttrs& text_attrs = attrs.bus_labels[color_index];
+			AddText((bus->is_roundtrip) ? std::move(bus_name_text) : bus_name_text, container, text_attrs, attrs.underlayer,
+				projection(bus->bus_stops[0]));
 
 			// Если маршрут не кольцевой - добавляем название маршрута у второй конечной остановки
 			if (!bus->is_roundtrip) {
 				const auto& second_end_station = bus->bus_stops[bus->bus_stops.size() / 2];
-				if (second_end_station->name != bus->bus_stops[0]->name) {
-					AddText(bus_name_text, doc, *color_iter, projector(second_end_station->coordinates));
+				if (second_end_station->id != bus->bus_stops[0]->id) {
+					AddText(std::move(bus_name_text), container, text_attrs, attrs.underlayer, projection(second_end_station));
 				}
 			}
-			(color_iter + 1 == settings_.color_palette.end()) ? color_iter = settings_.color_palette.begin() : ++color_iter;
+			color_index = (color_index + 1 == attrs.bus_labels.size()) ? 0 : color_index + 1;
 		}
 	}
 
-	void MapRenderer::RenderStopSymbols(const StopsContainer& stops, const SphereProjector& projector, svg::Document& doc) const {
-		 
+	void MapRenderer::RenderStopSymbols(const StopsContainer& stops, const StopsProjection& projection,
+		svg::ObjectContainer& container, const LayersAttrs& attrs) const
+	{
 		for (const auto& stop : stops) {
-			doc.Add(svg::Circle().SetCenter(projector(stop->coordinates))
-								.SetRadius(settings_.stop_radius)
-								.SetFillColor("white"s));
+			svg::Circle circle;
+			container.Add(std::move(SetAttrs(circle.SetCenter(projection(stop))
+								.SetRadius(settings_.stop_radius), attrs.stop_symbols)));
 		}
 	}
 
-	const svg::Text MapRenderer::GetStopBaseText(const std::string& name) const {
+	const svg::Text MapRenderer::GetStopBaseText(std::string_view name) const {
 		return svg::Text().SetOffset(settings_.stop_label_offset)
 			.SetFontSize(settings_.stop_label_font_size)
 			.SetFontFamily("Verdana"s)
-			.SetData(name);
+			.SetData(std::string(name));
 	}
 
-	void MapRenderer::RenderStopsText(const StopsContainer& stops, const SphereProjector& projector, svg::Document& doc) const {
+	void MapRenderer::RenderStopsText(const StopsContainer& stops, const StopsProjection& projection,
+		svg::ObjectContainer& container, const LayersAttrs& attrs) const
+	{
 
 		// Отрисовываем названия остановок
 		for (const auto& stop : stops) {
@@ -139,31 +310,218 @@ namespace renderer {
 			svg::Text stop_name_text = GetStopBaseText(stop->name);
 
 			// Добавляем название остановки
-			AddText(stop_name_text, doc, svg::Color("black"s), projector(stop->coordinates));
+			AddText(std::move(stop_name_text), container, attrs.stop_labels, attrs.underlayer, projection(stop));
 		}
 	}
 
-	svg::Document MapRenderer::Render(const BusesContainer& buses, const StopsContainer& stops) const{
+	void MapRenderer::RenderLayers(const BusesContainer& buses, const StopsContainer& stops,
+		svg::ObjectContainer& container) const
+	{
+		// Получаем проекцию остановок на карту (без сохранения: номер изменения каталога не известен)
+		const StopsProjection projection(CreateProjector(stops), stops);
 
-		svg::Document doc;
-		
-		// Создаём проектор сферических координат на карту и добавляем его в MapRenderer
-		const SphereProjector projector = CreateProjector(stops);
+		// Объекты выводятся позже с неизвестной точностью, поэтому атрибуты не форматируются заранее
+		const LayersAttrs attrs = GetLayersAttrs(std::nullopt);
 		
 		// Отрисовываем линии маршрутов
-		RenderLines(buses, projector, doc);
+		RenderLines(buses, projection, container, attrs);
 
 		// Отрисовываем названия маршрутов
-		RenderBusText(buses, projector, doc);
+		RenderBusText(buses, projection, container, attrs);
 
 		// Отрисовываем символы остановок
-		RenderStopSymbols(stops, projector, doc);
+		RenderStopSymbols(stops, projection, container, attrs);
 
 		// Отрисовываем названия остановок
-		RenderStopsText(stops, projector, doc);
+		RenderStopsText(stops, projection, container, attrs);
+	}
+
+	svg::Document MapRenderer::Render(const BusesContainer& buses, const StopsContainer& stops) const{
 
+		svg::Document doc;
+		RenderLayers(buses, stops, doc);
 		return doc;
 
 	}
 
+	void MapRenderer::UpdateFragments(const BusesContainer& buses, const std::vector<size_t>& color_indexes,
+		const StopsContainer& stops, const StopsProjection& projection, const LayersAttrs& attrs,
+		std::streamsize precision) const
+	{
+		if (fragments_precision_ != precision) {
+			bus_fragments_.clear();
+			stop_fragments_.clear();
+			fragments_precision_ = precision;
+		}
+
+		// Фрагменты, которые нужно отрисовать: индексы в buses и stops
+		std::vector<size_t> missing_buses;
+		for (size_t i = 0; i < buses.size(); ++i) {
+			if (buses[i]->id >= bus_fragments_.size()) {
+				bus_fragments_.resize(buses[i]->id + 1);
+			}
+			const auto& fragments = bus_fragments_[buses[i]->id];
+			if (fragments.bus != buses[i] || fragments.revision != buses[i]->revision
+				|| fragments.color_index != color_indexes[buses[i]->id]) {
+				missing_buses.push_back(i);
+			}
+		}
+		std::vector<size_t> missing_stops;
+		for (size_t i = 0; i < stops.size(); ++i) {
+			if (stops[i]->id >= stop_fragments_.size()) {
+				stop_fragments_.resize(stops[i]->id + 1);
+			}
+			const auto& fragments = stop_fragments_[stops[i]->id];
+			if (fragments.stop != stops[i] || fragments.revision != stops[i]->revision) {
+				missing_stops.push_back(i);
+			}
+		}
+
+		// Части по RENDER_CHUNK_SIZE фрагментов: сначала маршрутов, затем остановок
+		const size_t bus_chunks_count = (missing_buses.size() + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE;
+		const size_t chunks_count = bus_chunks_count + (missing_stops.size() + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE;
+		if (chunks_count == 0) {
+			return;
+		}
+
+		// Потоки по очереди забирают еще не отрисованные части. Каждый фрагмент записывается
+		// в свой элемент bus_fragments_ или stop_fragments_, размеры которых уже не меняются
+		std::atomic<size_t> next_chunk = 0;
+		auto render_chunks = [&]() {
+			std::ostringstream buffer;
+			buffer.precision(precision);
+			svg::ObjectStream container(buffer);
+			auto take_buffer = [&buffer]() {
+				std::string result = std::move(buffer).str();
+				buffer.str({});
+				return result;
+			};
+
+			for (size_t i = next_chunk++; i < chunks_count; i = next_chunk++) {
+				if (i < bus_chunks_count) {
+					const auto end = missing_buses.begin() + std::min(missing_buses.size(), (i + 1) * RENDER_CHUNK_SIZE);
+					for (auto iter = missing_buses.begin() + i * RENDER_CHUNK_SIZE; iter != end; ++iter) {
+						const domain::Bus* bus = buses[*iter];
+						auto& fragments = bus_fragments_[bus->id];
+						RenderLines({ &bus, 1 }, projection, container, attrs, color_indexes[bus->id]);
+						fragments.line = take_buffer();
+						RenderBusText({ &bus, 1 }, projection, container, attrs, color_indexes[bus->id]);
+						fragments.labels = take_buffer();
+						fragments.bus = bus;
+						fragments.revision = bus->revision;
+						fragments.color_index = color_indexes[bus->id];
+					}
+				}
+				else {
+					const size_t begin = (i - bus_chunks_count) * RENDER_CHUNK_SIZE;
+					const auto end = missing_stops.begin() + std::min(missing_stops.size(), begin + RENDER_CHUNK_SIZE);
+					for (auto iter = missing_stops.begin() + begin; iter != end; ++iter) {
+						const domain::Stop* stop = stops[*iter];
+						auto& fragments = stop_fragments_[stop->id];
+						RenderStopSymbols({ &stop, 1 }, projection, container, attrs);
+						fragments.symbol = take_buffer();
+						RenderStopsText({ &stop, 1 }, projection, container, attrs);
+						fragments.labels = take_buffer();
+						fragments.stop = stop;
+						fragments.revision = stop->revision;
+					}
+				}
+			}
+		};
+
+		const size_t threads_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), chunks_count);
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < threads_count; ++i) {
+			threads.emplace_back(render_chunks);
+		}
+		render_chunks();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	MapView MapRenderer::GetMapView(const StopsContainer& stops, uint64_t revision, const MapArea& area) const {
+
+		// Углы части карты
+		std::array<geo::Coordinates, 2> corners;
+		if (const auto box = std::get_if<MapBox>(&area)) {
+			corners = { box->min_corner, box->max_corner };
+		}
+		else {
+			const auto& tile = std::get<MapTile>(area);
+			if (!IsValidTile(tile)) {
+				throw std::invalid_argument("Invalid map tile"s);
+			}
+			const SphereProjector& projector = GetProjection(stops, revision).GetProjector();
+			const double tile_width = settings_.width / std::ldexp(1.0, tile.zoom);
+			const double tile_height = settings_.height / std::ldexp(1.0, tile.zoom);
+			corners = {
+				projector.Unproject({ tile.x * tile_width, (tile.y + 1) * tile_height }),
+				projector.Unproject({ (tile.x + 1) * tile_width, tile.y * tile_height })
+			};
+		}
+		const SphereProjector projector(corners.begin(), corners.end(), settings_.width, settings_.height, 0.0);
+
+		// Запас в пикселях: объекты с опорной точкой в нем могут задевать часть карты.
+		// Длина надписей заранее не известна, поэтому учитываются только их смещение и размер шрифта
+		const double margin = settings_.underlayer_width + std::max({ settings_.line_width / 2, settings_.stop_radius,
+			std::max(std::abs(settings_.bus_label_offset.x), std::abs(settings_.bus_label_offset.y)) + settings_.bus_label_font_size,
+			std::max(std::abs(settings_.stop_label_offset.x), std::abs(settings_.stop_label_offset.y)) + settings_.stop_label_font_size });
+
+		return {
+			projector,
+			projector.Unproject({ -margin, settings_.height + margin }),
+			projector.Unproject({ settings_.width + margin, -margin })
+		};
+	}
+
+	void MapRenderer::Render(const MapView& view, const BusesContainer& buses, uint64_t revision,
+		const BusesContainer& visible_buses,
+		const StopsContainer& visible_stops, std::ostream& out) const
+	{
+		// Цвета маршрутов те же, что на всей карте
+		const std::vector<size_t>& color_indexes = GetColorIndexes(buses, revision);
+
+		// Видимых остановок мало, они проецируются при обращении
+		const StopsProjection projection(view.projector);
+		const LayersAttrs attrs = GetLayersAttrs(out.precision());
+
+		svg::StreamDocument doc(out);
+		for (const auto bus : visible_buses) {
+			RenderLines({ &bus, 1 }, projection, doc, attrs, color_indexes[bus->id]);
+		}
+		for (const auto bus : visible_buses) {
+			RenderBusText({ &bus, 1 }, projection, doc, attrs, color_indexes[bus->id]);
+		}
+		RenderStopSymbols(visible_stops, projection, doc, attrs);
+		RenderStopsText(visible_stops, projection, doc, attrs);
+		doc.Finish();
+	}
+
+	void MapRenderer::Render(const BusesContainer& buses, const StopsContainer& stops, uint64_t revision,
+		std::ostream& out) const
+	{
+		const StopsProjection& projection = GetProjection(stops, revision);
+		const std::vector<size_t>& color_indexes = GetColorIndexes(buses, revision);
+
+		UpdateFragments(buses, color_indexes, stops, projection, GetLayersAttrs(out.precision()), out.precision());
+
+		// Слои карты выводятся в прежнем порядке: линии и названия маршрутов, символы и названия остановок
+		svg::StreamDocument doc(out);
+		for (const auto bus : buses) {
+			out << bus_fragments_[bus->id].line;
+		}
+		for (const auto bus : buses) {
+			out << bus_fragments_[bus->id].labels;
+		}
+		for (const auto stop : stops) {
+			out << stop_fragments_[stop->id].symbol;
+		}
+		for (const auto stop : stops) {
+			out << stop_fragments_[stop->id].labels;
+		}
+		doc.Finish();
+
+	}
+
 } // namespace renderer
\ No newline at end of file
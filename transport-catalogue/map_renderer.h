@@ -4,17 +4,22 @@
 #include "domain.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
 #include <vector>
 
 namespace renderer {
 
     // Для хранения уникальных маршрутов в лексиграфическом порядке по названию
-    using BusesContainer = std::vector<const domain::Bus*>;
+    using BusesContainer = std::span<const domain::Bus* const>;
 
     // Для хранения уникальных остановок в лексиграфическом порядке по названию
-    using StopsContainer = std::vector<const domain::Stop*>;
+    using StopsContainer = std::span<const domain::Stop* const>;
 
     inline const double EPSILON = 1e-6;
     inline bool IsZero(double value) {
@@ -86,6 +91,21 @@ namespace renderer {
             };
         }
 
+        // Возвращает широту и долготу точки SVG-изображения (обратное преобразование).
+        // При нулевом масштабе все точки изображения соответствуют одной точке поверхности
+        geo::Coordinates Unproject(svg::Point point) const {
+            if (IsZero(zoom_coeff_)) {
+                return { max_lat_, min_lon_ };
+            }
+            return {
+                max_lat_ - (point.y - padding_) / zoom_coeff_,
+                (point.x - padding_) / zoom_coeff_ + min_lon_
+            };
+        }
+
+        // Проекторы равны, если одинаково проецируют все точки
+        bool operator==(const SphereProjector& other) const = default;
+
     private:
         double padding_ = 0.0;
         double min_lon_ = 0.0;
@@ -93,6 +113,32 @@ namespace renderer {
         double zoom_coeff_ = 0.0;
     };
 
+    /*
+     * Точки SVG-изображения остановок. Для всей карты точки остановок вычисляются один раз
+     * и хранятся по domain::Stop::id, для части карты остановки проецируются при обращении
+     */
+    class StopsProjection {
+    public:
+
+        explicit StopsProjection(const SphereProjector& projector)
+            : projector_(projector)
+        {
+        }
+
+        // Проецирует остановки stops, далее можно обращаться только к ним
+        StopsProjection(const SphereProjector& projector, const StopsContainer& stops);
+
+        svg::Point operator()(const domain::Stop* stop) const {
+            return (points_.empty()) ? projector_(stop->coordinates) : points_[stop->id];
+        }
+
+        const SphereProjector& GetProjector() const { return projector_; }
+
+    private:
+        SphereProjector projector_;
+        std::vector<svg::Point> points_;
+    };
+
     // Структура для хранения настроек MapRenderer
     struct MapRendererSettings {
         double width = 0.0;
@@ -107,63 +153,212 @@ namespace renderer {
         svg::Color underlayer_color;
         double underlayer_width = 0.0;
         std::vector<svg::Color> color_palette;
+        // Допуск упрощения линий маршрутов в пикселях: вершины ближе допуска к предыдущей
+        // отбрасываются, затем линия упрощается алгоритмом Дугласа - Пекера (0 - без упрощения)
+        double polyline_tolerance = 0.0;
     };
 
 
+    // Тайл zoom/x/y: изображение всей карты делится на 2^zoom x 2^zoom равных частей,
+    // тайл - часть в столбце x и строке y, растянутая до размеров карты
+    struct MapTile {
+        int zoom = 0;
+        int x = 0;
+        int y = 0;
+    };
+
+    // Наибольший zoom тайла: при нем номера столбцов и строк еще помещаются в int
+    inline constexpr int MAX_TILE_ZOOM = 30;
+
+    // Проверяет, что тайл существует: 0 <= zoom <= MAX_TILE_ZOOM, 0 <= x, y < 2^zoom
+    bool IsValidTile(const MapTile& tile);
+
+    // Прямоугольник координат [min_corner, max_corner], вписанный в размеры карты без отступов
+    struct MapBox {
+        geo::Coordinates min_corner;
+        geo::Coordinates max_corner;
+    };
+
+    using MapArea = std::variant<MapTile, MapBox>;
+
+    // Отрисовываемая часть карты: ее проектор и границы координат, в которых лежат опорные точки
+    // попадающих в нее объектов
+    struct MapView {
+        SphereProjector projector;
+        geo::Coordinates min_corner;
+        geo::Coordinates max_corner;
+    };
+
+    /*
+     * Отрисовщик карты. Render и GetMapView с номером изменения каталога сохраняют между вызовами
+     * проекцию карты, индексы цветов и фрагменты SVG всех маршрутов и остановок, то есть держат
+     * в памяти копию всей выведенной карты, пока жив объект. Эти данные меняются и в константных
+     * методах без синхронизации, поэтому один MapRenderer нельзя вызывать из нескольких потоков
+     * одновременно (параллельная отрисовка фрагментов внутри Render этому не мешает)
+     */
     class MapRenderer {
     public:
 
         MapRenderer(MapRendererSettings settings)
             :settings_(std::move(settings))
         {
+            // Цвета форматируются один раз здесь, а не при выводе каждого объекта карты
+            for (auto& color : settings_.color_palette) {
+                color = svg::ToFormattedColor(color);
+            }
+            settings_.underlayer_color = svg::ToFormattedColor(settings_.underlayer_color);
         }
 
         // Возвращает svg::Document с визуализиацией карты маршрутов 
         svg::Document Render(const BusesContainer& buses, const StopsContainer& stops) const;
 
+        // Выводит визуализацию карты маршрутов в поток out, не строя svg::Document. Отрисованные фрагменты
+        // маршрутов и остановок сохраняются между вызовами, и заново отрисовываются только новые и измененные
+        // (по domain::Bus::revision и domain::Stop::revision) маршруты и остановки и маршруты, у которых сменился цвет. Если границы карты сдвинулись, отрисовывается
+        // вся карта. Фрагменты отрисовываются параллельно частями по RENDER_CHUNK_SIZE элементов.
+        // revision - номер изменения каталога (TransportCatalogue::GetRevision), проекция карты
+        // вычисляется заново, только если он изменился
+        void Render(const BusesContainer& buses, const StopsContainer& stops, uint64_t revision, std::ostream& out) const;
+
+        // Возвращает проектор и границы части карты area, stops - все остановки карты,
+        // revision - номер изменения каталога, как в Render. Для несуществующего тайла
+        // выбрасывает std::invalid_argument
+        MapView GetMapView(const StopsContainer& stops, uint64_t revision, const MapArea& area) const;
+
+        // Выводит в поток out часть карты view: buses - все маршруты карты (по ним выбираются цвета),
+        // revision - номер изменения каталога, как в Render, visible_buses и visible_stops - маршруты
+        // и остановки, попадающие в view, в порядке названий
+        void Render(const MapView& view, const BusesContainer& buses, uint64_t revision,
+            const BusesContainer& visible_buses, const StopsContainer& visible_stops, std::ostream& out) const;
+
     private:
         MapRendererSettings settings_;
 
+        // Проекция всей карты, сохраненная между отрисовками, и номер изменения каталога, для которого
+        // она вычислена. Обновляется в начале отрисовки, до запуска потоков
+        mutable std::optional<StopsProjection> projection_;
+        mutable uint64_t projection_revision_ = 0;
+
+        // Индексы цветов палитры маршрутов по domain::Bus::id, сохраненные между отрисовками
+        // всей карты и ее частей, и номер изменения каталога, для которого они вычислены
+        mutable std::vector<size_t> color_indexes_;
+        mutable std::optional<uint64_t> color_indexes_revision_;
+
+        // Отрисованные фрагменты SVG маршрута: линия и надписи у конечных, выведенные цветом color_index
+        // по маршруту с номером изменения revision
+        struct BusFragments {
+            const domain::Bus* bus = nullptr;
+            uint64_t revision = 0;
+            size_t color_index = 0;
+            std::string line;
+            std::string labels;
+        };
+
+        // Отрисованные фрагменты SVG остановки с номером изменения revision: символ и надпись
+        struct StopFragments {
+            const domain::Stop* stop = nullptr;
+            uint64_t revision = 0;
+            std::string symbol;
+            std::string labels;
+        };
+
+        // Фрагменты всей карты по domain::Bus::id и domain::Stop::id, сохраненные между отрисовками.
+        // Верны, пока не изменился проектор и точность вывода чисел fragments_precision_
+        mutable std::vector<BusFragments> bus_fragments_;
+        mutable std::vector<StopFragments> stop_fragments_;
+        mutable std::streamsize fragments_precision_ = 0;
+
+        // Количество маршрутов или остановок в одной части при параллельной отрисовке фрагментов
+        static constexpr size_t RENDER_CHUNK_SIZE = 1024;
+
+        // Атрибуты fill и stroke объектов одного вида. formatted - те же атрибуты, отформатированные
+        // один раз на отрисовку: объекты ссылаются на строку без копирования цветов. Строка пустая,
+        // если объекты сохраняются в svg::Document и выводятся позже с заранее неизвестной точностью
+        struct ObjectAttrs {
+            svg::PathAttrs attrs;
+            std::string formatted;
+        };
+
+        // Атрибуты объектов всех слоев карты, линий и названий маршрутов - по индексам цветов палитры
+        struct LayersAttrs {
+            std::vector<ObjectAttrs> lines;
+            std::vector<ObjectAttrs> bus_labels;
+            ObjectAttrs underlayer;
+            ObjectAttrs stop_symbols;
+            ObjectAttrs stop_labels;
+        };
+
         //------------------------------------------------------
         
                     // Функции отрисовки
 
-        // Отрисовывает линии маршрутов Bus
-        void RenderLines(const BusesContainer& buses, const SphereProjector& projector, svg::Document& doc) const;
+        // Добавляет в container все слои карты
+        void RenderLayers(const BusesContainer& buses, const StopsContainer& stops, svg::ObjectContainer& container) const;
+
+        // Возвращает индексы цветов палитры маршрутов buses по domain::Bus::id, вычисляя их заново,
+        // только если изменился номер изменения каталога revision
+        const std::vector<size_t>& GetColorIndexes(const BusesContainer& buses, uint64_t revision) const;
+
+        // Возвращает проекцию всей карты с остановками stops, вычисляя ее заново, только если изменился
+        // номер изменения каталога revision. Если при этом изменился проектор, сохраненные фрагменты
+        // карты сбрасываются
+        const StopsProjection& GetProjection(const StopsContainer& stops, uint64_t revision) const;
 
-        // Отрисовывает текст названия маршрутов Bus
-        void RenderBusText(const BusesContainer& buses, const SphereProjector& projector, svg::Document& doc) const;
+        // Отрисовывает фрагменты маршрутов и остановок, которых нет среди сохраненных или которые
+        // устарели; color_indexes - индексы цветов маршрутов по domain::Bus::id
+        void UpdateFragments(const BusesContainer& buses, const std::vector<size_t>& color_indexes,
+            const StopsContainer& stops, const StopsProjection& projection, const LayersAttrs& attrs,
+            std::streamsize precision) const;
+
+        // Отрисовывает линии маршрутов Bus, первый непустой маршрут получает цвет палитры с индексом color_index
+        void RenderLines(const BusesContainer& buses, const StopsProjection& projection, svg::ObjectContainer& container,
+            const LayersAttrs& attrs, size_t color_index = 0) const;
+
+        // Отрисовывает текст названия маршрутов Bus, цвета выбираются так же, как в RenderLines
+        void RenderBusText(const BusesContainer& buses, const StopsProjection& projection, svg::ObjectContainer& container,
+            const LayersAttrs& attrs, size_t color_index = 0) const;
 
         // Отрисовывает символы остановок
-        void RenderStopSymbols(const StopsContainer& stops, const SphereProjector& projector, svg::Document& doc) const;
+        void RenderStopSymbols(const StopsContainer& stops, const StopsProjection& projection, svg::ObjectContainer& container,
+            const LayersAttrs& attrs) const;
 
         // Отрисовывает названия остановок
-        void RenderStopsText(const StopsContainer& stops, const SphereProjector& projector, svg::Document& doc) const;
+        void RenderStopsText(const StopsContainer& stops, const StopsProjection& projection, svg::ObjectContainer& container,
+            const LayersAttrs& attrs) const;
 
         //------------------------------------------------------
         
             // Вспомогательные функции отрисовки
 
         // Возвращает линию маршрута Bus
-        const svg::Polyline GetPolylineRoute(const domain::Bus* bus, const SphereProjector& projector) const;
+        const svg::Polyline GetPolylineRoute(const domain::Bus* bus, const StopsProjection& projection) const;
 
         // Возвращает "базовый" текст названия маршрута Bus
-        const svg::Text GetBusBaseText(const std::string& name) const;
+        const svg::Text GetBusBaseText(std::string_view name) const;
 
         // Добавляет текст, а именно текстовую подложку и сам основной текст
-        void AddText(const svg::Text& base_text, svg::Document& doc, const svg::Color& color, const svg::Point& point) const;
+        // (подложка копирует base_text, основная надпись забирает его себе)
+        void AddText(svg::Text base_text, svg::ObjectContainer& container, const ObjectAttrs& text_attrs,
+            const ObjectAttrs& underlayer_attrs, const svg::Point& point) const;
 
         // Получаем "базовый" текст названия остановки Stop
-        const svg::Text GetStopBaseText(const std::string& name) const;
+        const svg::Text GetStopBaseText(std::string_view name) const;
 
         //------------------------------------------------------
 
                 // Вспомогательные функции
         
-        // Возвращает набор всех координат всех маршрутов Bus
-        const std::vector<geo::Coordinates> GetAllCoordinates(const StopsContainer& stops) const;
+        // Возвращает атрибуты объектов слоев карты, отформатированные с точностью precision, если она задана
+        LayersAttrs GetLayersAttrs(std::optional<std::streamsize> precision) const;
+
+        // Задает объекту атрибуты attrs: отформатированную строку, если она есть, иначе сами атрибуты
+        template <typename Object>
+        static Object& SetAttrs(Object& object, const ObjectAttrs& attrs) {
+            return (attrs.formatted.empty()) ? object.SetAttrs(attrs.attrs) : object.SetFormattedAttrs(attrs.formatted);
+        }
 
-        // Возвращает SphereProjector постороенный из BusesContainer
+        // Возвращает SphereProjector постороенный из StopsContainer
+        // (по крайним координатам остановок, без копирования всех координат)
         const SphereProjector CreateProjector(const StopsContainer& stops) const;
 
     };
@@ -0,0 +1,305 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace router {
+
+RaptorRoute::RaptorRoute(const Catalogue& catalogue)
+	:names_(&catalogue.GetNames())
+	,bus_wait_time_(static_cast<double>(catalogue.GetBusWaitTime()))
+	,time_coef_(60 / (catalogue.GetBusVelocity() * 1000))
+{
+	const auto stops = catalogue.GetUniqueStops();
+	index_to_stops_.reserve(stops.size());
+	for (const auto stop : stops) {
+		stops_to_index_.insert({ stop->name, static_cast<uint32_t>(index_to_stops_.size()) });
+		index_to_stops_.push_back(stop->name_handle);
+	}
+
+	for (const auto bus : catalogue.GetUniqueBuses()) {
+		const size_t stops_count = bus->bus_stops.size();
+		if (bus->is_roundtrip) {
+			AddLine(*bus, 0, stops_count);
+		}
+		else {
+			const size_t half_range = stops_count / 2;
+			AddLine(*bus, 0, stops_count - half_range);
+			AddLine(*bus, half_range, stops_count);
+		}
+	}
+
+	IndexStopPositions();
+}
+
+void RaptorRoute::AddLine(const domain::Bus& bus, size_t begin_index, size_t end_index) {
+	if (end_index - begin_index < 2) {
+		return;
+	}
+	Line line{ .bus_name = bus.name_handle, .begin = static_cast<uint32_t>(line_stops_.size()), .end = 0 };
+
+	for (size_t i = begin_index; i < end_index; ++i) {
+		line_stops_.push_back(stops_to_index_.at(bus.bus_stops[i]->name));
+		line_distances_.push_back(bus.GetDistance(begin_index, i));
+	}
+	line.end = static_cast<uint32_t>(line_stops_.size());
+	lines_.push_back(line);
+}
+
+void RaptorRoute::IndexStopPositions() {
+	stop_positions_begin_.assign(index_to_stops_.size() + 1, 0);
+	for (const auto stop : line_stops_) {
+		++stop_positions_begin_[stop + 1];
+	}
+	for (size_t i = 1; i < stop_positions_begin_.size(); ++i) {
+		stop_positions_begin_[i] += stop_positions_begin_[i - 1];
+	}
+
+	stop_positions_.resize(line_stops_.size());
+	stop_position_lines_.resize(line_stops_.size());
+	std::vector<uint32_t> next_free = stop_positions_begin_;
+	for (uint32_t line_index = 0; line_index < lines_.size(); ++line_index) {
+		for (uint32_t position = lines_[line_index].begin; position < lines_[line_index].end; ++position) {
+			const uint32_t slot = next_free[line_stops_[position]]++;
+			stop_positions_[slot] = position;
+			stop_position_lines_[slot] = line_index;
+		}
+	}
+}
+
+const std::optional<RouterInformation> RaptorRoute::GetRouteInfo(std::string_view from, std::string_view to) const {
+	const auto from_iter = stops_to_index_.find(from);
+	const auto to_iter = stops_to_index_.find(to);
+	if (from_iter == stops_to_index_.end() || to_iter == stops_to_index_.end()) {
+		return std::nullopt;
+	}
+
+	const SearchState state = Search({ { from_iter->second, 0.0 } }, { { to_iter->second, 0.0 } });
+	if (std::isinf(state.arrivals[(state.rounds_count - 1) * index_to_stops_.size() + to_iter->second])) {
+		return std::nullopt;
+	}
+	return BuildRouterInformation(state, to_iter->second);
+}
+
+const std::optional<std::vector<ReachableStop>> RaptorRoute::GetReachableStops(std::string_view from,
+	double max_time) const
+{
+	const auto from_iter = stops_to_index_.find(from);
+	if (from_iter == stops_to_index_.end()) {
+		return std::nullopt;
+	}
+
+	const SearchState state = Search({ { from_iter->second, 0.0 } }, {}, max_time);
+	const size_t offset = (state.rounds_count - 1) * index_to_stops_.size();
+
+	std::vector<ReachableStop> result;
+	for (uint32_t stop = 0; stop < index_to_stops_.size(); ++stop) {
+		if (state.arrivals[offset + stop] <= max_time) {
+			result.push_back({ names_->GetString(index_to_stops_[stop]), state.arrivals[offset + stop] });
+		}
+	}
+	SortReachableStops(result);
+
+	return result;
+}
+
+const std::optional<RouterInformation> RaptorRoute::GetRouteInfo(const std::vector<RouteEndpoint>& sources,
+	const std::vector<RouteEndpoint>& targets) const
+{
+	// Остановки, известные маршрутизатору, и соответствующие им элементы endpoints
+	auto to_stop_endpoints = [this](const std::vector<RouteEndpoint>& endpoints,
+		std::vector<const RouteEndpoint*>& known_endpoints) {
+		std::vector<StopEndpoint> result;
+		for (const auto& endpoint : endpoints) {
+			if (const auto iter = stops_to_index_.find(endpoint.stop_name); iter != stops_to_index_.end()) {
+				result.push_back({ iter->second, endpoint.walk_time });
+				known_endpoints.push_back(&endpoint);
+			}
+		}
+		return result;
+	};
+	std::vector<const RouteEndpoint*> known_sources, known_targets;
+	const auto stop_sources = to_stop_endpoints(sources, known_sources);
+	const auto stop_targets = to_stop_endpoints(targets, known_targets);
+
+	const SearchState state = Search(stop_sources, stop_targets);
+	const size_t offset = (state.rounds_count - 1) * index_to_stops_.size();
+
+	// Выбираем остановку конца с наименьшим временем вместе с пешим путем от нее
+	size_t best_target = stop_targets.size();
+	double best_time = std::numeric_limits<double>::infinity();
+	for (size_t i = 0; i < stop_targets.size(); ++i) {
+		const double time = state.arrivals[offset + stop_targets[i].first] + stop_targets[i].second;
+		if (time < best_time) {
+			best_time = time;
+			best_target = i;
+		}
+	}
+	if (best_target == stop_targets.size()) {
+		return std::nullopt;
+	}
+
+	RouterInformation result = BuildRouterInformation(state, stop_targets[best_target].first);
+
+	// Метки нулевого раунда есть только у остановок начала, с одной из них начинается первая посадка
+	const uint32_t source_stop = (result.items.empty()) ? stop_targets[best_target].first
+		: stops_to_index_.at(result.items.front().data);
+	const RouteEndpoint* best_source = nullptr;
+	for (size_t i = 0; i < stop_sources.size(); ++i) {
+		if (stop_sources[i].first == source_stop
+			&& (!best_source || stop_sources[i].second < best_source->walk_time)) {
+			best_source = known_sources[i];
+		}
+	}
+	InsertWalkItems(result, *best_source, *known_targets[best_target]);
+
+	return result;
+}
+
+RaptorRoute::SearchState RaptorRoute::Search(const std::vector<StopEndpoint>& sources,
+	const std::vector<StopEndpoint>& targets, double max_time) const
+{
+	const size_t stops_count = index_to_stops_.size();
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	SearchState state;
+	state.arrivals.assign(stops_count, infinity);
+	state.boardings.assign(stops_count, {});
+	state.rounds_count = 1;
+
+	// Наилучшее время прибытия на остановку среди всех раундов
+	std::vector<double> best_arrivals(stops_count, infinity);
+
+	// Остановки, метки которых улучшились в последнем раунде
+	std::vector<uint32_t> marked_stops;
+	std::vector<bool> is_marked(stops_count, false);
+
+	for (const auto& [stop, time] : sources) {
+		if (time < state.arrivals[stop]) {
+			state.arrivals[stop] = time;
+			best_arrivals[stop] = time;
+		}
+		if (!is_marked[stop]) {
+			is_marked[stop] = true;
+			marked_stops.push_back(stop);
+		}
+	}
+
+	// Время лучшего найденного пути до остановок targets: метки не хуже него не нужны
+	auto get_target_bound = [&]() {
+		double result = infinity;
+		for (const auto& [stop, time] : targets) {
+			result = std::min(result, best_arrivals[stop] + time);
+		}
+		return result;
+	};
+
+	// Линии, которые нужно просмотреть в раунде, и позиции, с которых начинается просмотр
+	std::vector<uint32_t> marked_lines;
+	std::vector<uint32_t> first_positions(lines_.size(), NO_POSITION);
+
+	while (!marked_stops.empty()) {
+		for (const auto stop : marked_stops) {
+			is_marked[stop] = false;
+			for (uint32_t i = stop_positions_begin_[stop]; i < stop_positions_begin_[stop + 1]; ++i) {
+				const uint32_t line_index = stop_position_lines_[i];
+				if (first_positions[line_index] == NO_POSITION) {
+					marked_lines.push_back(line_index);
+				}
+				first_positions[line_index] = std::min(first_positions[line_index], stop_positions_[i]);
+			}
+		}
+		marked_stops.clear();
+
+		// Метки нового раунда начинаются с меток предыдущего. Линии внутри раунда
+		// читают только метки предыдущего раунда и независимы друг от друга
+		const size_t prev_offset = (state.rounds_count - 1) * stops_count;
+		const size_t offset = state.rounds_count * stops_count;
+		state.arrivals.resize(offset + stops_count);
+		std::copy_n(state.arrivals.begin() + prev_offset, stops_count, state.arrivals.begin() + offset);
+		state.boardings.resize(offset + stops_count);
+		++state.rounds_count;
+
+		for (const auto line_index : marked_lines) {
+			// Позиция посадки и время отправления с нее (с учетом ожидания автобуса)
+			uint32_t board_position = NO_POSITION;
+			double departure_time = 0.0;
+
+			for (uint32_t position = first_positions[line_index]; position < lines_[line_index].end; ++position) {
+				const uint32_t stop = line_stops_[position];
+
+				if (board_position != NO_POSITION) {
+					const double arrival = departure_time + GetRideTime(board_position, position);
+					const double bound = std::min(best_arrivals[stop], get_target_bound());
+					if (arrival < bound && arrival <= max_time) {
+						best_arrivals[stop] = arrival;
+						state.arrivals[offset + stop] = arrival;
+						state.boardings[offset + stop] = { line_index, board_position, position };
+						if (!is_marked[stop]) {
+							is_marked[stop] = true;
+							marked_stops.push_back(stop);
+						}
+					}
+				}
+
+				// Пересаживаемся на этот же автобус здесь, если так приедем раньше
+				const double prev_arrival = state.arrivals[prev_offset + stop];
+				if (!std::isinf(prev_arrival)) {
+					const double departure = prev_arrival + bus_wait_time_;
+					if (board_position == NO_POSITION
+						|| departure < departure_time + GetRideTime(board_position, position)) {
+						board_position = position;
+						departure_time = departure;
+					}
+				}
+			}
+			first_positions[line_index] = NO_POSITION;
+		}
+		marked_lines.clear();
+	}
+
+	return state;
+}
+
+RouterInformation RaptorRoute::BuildRouterInformation(const SearchState& state, uint32_t to) const {
+	const size_t stops_count = index_to_stops_.size();
+
+	RouterInformation result;
+	size_t round = state.rounds_count - 1;
+
+	// Идем от конечной остановки к начальной, элементы маршрута добавляются в обратном порядке
+	uint32_t stop = to;
+	while (true) {
+		// Ищем раунд, в котором была получена метка остановки
+		while (round > 0 && state.boardings[round * stops_count + stop].line == NO_POSITION) {
+			--round;
+		}
+		if (round == 0) {
+			break;
+		}
+		const Boarding& boarding = state.boardings[round * stops_count + stop];
+		const uint32_t board_stop = line_stops_[boarding.board_position];
+
+		result.items.push_back(RouteItem{
+			.type = RouteType::BUS,
+			.span_count = static_cast<int>(boarding.alight_position - boarding.board_position),
+			.time = GetRideTime(boarding.board_position, boarding.alight_position),
+			.data = names_->GetString(lines_[boarding.line].bus_name)
+			});
+		result.items.push_back(RouteItem{
+			.type = RouteType::WAIT,
+			.time = bus_wait_time_,
+			.data = names_->GetString(index_to_stops_[board_stop])
+			});
+
+		stop = board_stop;
+		--round;
+	}
+	std::reverse(result.items.begin(), result.items.end());
+	result.total_time = ComputeTotalTime(result.items);
+
+	return result;
+}
+
+} // namespace router
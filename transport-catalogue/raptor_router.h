@@ -0,0 +1,115 @@
+#pragma once
+
+#include "router_information.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace router {
+
+/*
+ * Маршрутизатор, работающий напрямую с последовательностями остановок маршрутов Bus
+ * по схеме RAPTOR: поиск ведется раундами, в k-м раунде находятся пути ровно с k посадками.
+ * Ожидание автобуса bus_wait_time при каждой посадке играет роль стоимости пересадки,
+ * граф с ребрами между всеми парами остановок маршрута не строится
+ */
+class RaptorRoute {
+private:
+
+	using Catalogue = transport_catalogue::TransportCatalogue;
+
+public:
+
+	explicit RaptorRoute(const Catalogue& catalogue);
+
+	const std::optional<RouterInformation> GetRouteInfo(std::string_view from, std::string_view to) const;
+
+	// Возвращает наилучший маршрут от любой из остановок sources до любой из остановок targets
+	// с учетом пешего пути до них (за один поиск)
+	const std::optional<RouterInformation> GetRouteInfo(const std::vector<RouteEndpoint>& sources,
+		const std::vector<RouteEndpoint>& targets) const;
+
+	const std::optional<std::vector<ReachableStop>> GetReachableStops(std::string_view from, double max_time) const;
+
+private:
+
+	static constexpr uint32_t NO_POSITION = UINT32_MAX;
+
+	// Остановка начала или конца поиска и время, которое добавляется к пути в ней
+	using StopEndpoint = std::pair<uint32_t, double>;
+
+	// Линия - участок маршрута Bus, по которому можно ехать без пересадки:
+	// кольцевой маршрут целиком, некольцевой - отдельно в прямом и обратном направлении.
+	// Остановки и расстояния линии хранятся подряд в line_stops_ и line_distances_
+	// на позициях [begin, end)
+	struct Line {
+		// Дескриптор названия маршрута в пуле строк TransportCatalogue
+		transport_catalogue::detail::StringPool::Handle bus_name = 0;
+		uint32_t begin = 0;
+		uint32_t end = 0;
+	};
+
+	// Посадка, которой получена метка остановки в раунде: линия, позиции посадки и высадки
+	struct Boarding {
+		uint32_t line = NO_POSITION;
+		uint32_t board_position = NO_POSITION;
+		uint32_t alight_position = NO_POSITION;
+	};
+
+	// Метки всех раундов поиска: arrivals[k * S + s] - наименьшее время прибытия на остановку s
+	// не более чем с k посадками, boardings[k * S + s] - посадка, улучшившая метку в раунде k
+	struct SearchState {
+		std::vector<double> arrivals;
+		std::vector<Boarding> boardings;
+		size_t rounds_count = 0;
+	};
+
+	// Пул названий TransportCatalogue, по которому дескрипторы переводятся в названия для ответов
+	const transport_catalogue::detail::StringPool* names_ = nullptr;
+
+	double bus_wait_time_ = 0.0;
+	double time_coef_ = 0.0;
+
+	// Контейнеры для хранения остановок, index_to_stops_ хранит дескрипторы названий
+	std::unordered_map<std::string_view, uint32_t> stops_to_index_;
+	std::vector<transport_catalogue::detail::StringPool::Handle> index_to_stops_;
+
+	std::vector<Line> lines_;
+
+	// Остановки всех линий, записанные подряд, и расстояния от начала линии до остановки
+	std::vector<uint32_t> line_stops_;
+	std::vector<int> line_distances_;
+
+	// Для каждой остановки s - позиции в line_stops_ на отрезке
+	// [stop_positions_begin_[s], stop_positions_begin_[s + 1]) и линии этих позиций
+	std::vector<uint32_t> stop_positions_begin_;
+	std::vector<uint32_t> stop_positions_;
+	std::vector<uint32_t> stop_position_lines_;
+
+	// Добавляет линию из остановок маршрута bus с индексами [begin_index, end_index)
+	void AddLine(const domain::Bus& bus, size_t begin_index, size_t end_index);
+
+	// Заполняет stop_positions_begin_, stop_positions_ и stop_position_lines_
+	void IndexStopPositions();
+
+	// Возвращает время поездки по линии между позициями from_position и to_position
+	double GetRideTime(uint32_t from_position, uint32_t to_position) const {
+		return (line_distances_[to_position] - line_distances_[from_position]) * time_coef_;
+	}
+
+	// Выполняет раунды поиска от остановок sources, пока метки улучшаются. Метки, которые не
+	// улучшают путь до остановок targets, и метки со временем больше max_time не устанавливаются
+	SearchState Search(const std::vector<StopEndpoint>& sources, const std::vector<StopEndpoint>& targets,
+		double max_time = std::numeric_limits<double>::infinity()) const;
+
+	// Восстанавливает маршрут до остановки to по меткам поиска
+	RouterInformation BuildRouterInformation(const SearchState& state, uint32_t to) const;
+};
+
+} // namespace router
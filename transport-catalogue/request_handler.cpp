@@ -1,5 +1,6 @@
 #include "request_handler.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace handler {
@@ -30,10 +31,56 @@ namespace handler {
 		return renderer_.Render(GetBusesPtr(), GetStopsPtr());
 	}
 
+	void RequestHandler::RenderMap(std::ostream& out) const {
+		renderer_.Render(GetBusesPtr(), GetStopsPtr(), catalogue_.GetRevision(), out);
+	}
+
+	void RequestHandler::RenderMap(const renderer::MapArea& area, std::ostream& out) const {
+		const renderer::MapView view = renderer_.GetMapView(GetStopsPtr(), catalogue_.GetRevision(), area);
+
+		const auto buses = catalogue_.GetBusesInBox(view.min_corner, view.max_corner);
+
+		// На карте есть только остановки, через которые проходят маршруты
+		auto stops = catalogue_.GetStopsInBox(view.min_corner, view.max_corner);
+		stops.erase(std::remove_if(stops.begin(), stops.end(), [this](const domain::Stop* stop) {
+			return catalogue_.GetBusesByStop(stop->name).empty();
+			}), stops.end());
+
+		renderer_.Render(view, GetBusesPtr(), catalogue_.GetRevision(), buses, stops, out);
+	}
+
 	const optional<RequestHandler::RouterInformation> RequestHandler::GetRouterInfo(string_view from,
 		string_view to) const
 	{
 		return router_.GetRouteInfo(from, to);
 	}
 
+	const optional<RequestHandler::RouterInformation> RequestHandler::GetRouterInfo(geo::Coordinates from,
+		geo::Coordinates to) const
+	{
+		const size_t walk_stops_count = router_.GetSettings().walk_stops_count;
+		return router_.GetRouteInfo(catalogue_.GetNearestServedStops(from, walk_stops_count),
+			catalogue_.GetNearestServedStops(to, walk_stops_count));
+	}
+
+	const optional<RequestHandler::ReachableStops> RequestHandler::GetReachableStops(string_view from,
+		double max_time) const
+	{
+		return router_.GetReachableStops(from, max_time);
+	}
+
+	RequestHandler::StopsDistances RequestHandler::GetNearestStops(geo::Coordinates center, size_t count) const {
+		return catalogue_.GetNearestStops(center, count);
+	}
+
+	RequestHandler::StopsDistances RequestHandler::GetStopsWithinRadius(geo::Coordinates center, double radius) const {
+		return catalogue_.GetStopsWithinRadius(center, radius);
+	}
+
+	vector<const domain::Stop*> RequestHandler::GetStopsInBox(geo::Coordinates min_corner,
+		geo::Coordinates max_corner) const
+	{
+		return catalogue_.GetStopsInBox(min_corner, max_corner);
+	}
+
 } // namespace handler
\ No newline at end of file
@@ -12,9 +12,11 @@ class RequestHandler {
 
 private:
 
-    using StopInformation = std::set < std::string_view>;
+    using StopInformation = std::span<const std::string_view>;
     using RouteInformation = transport_catalogue::detail::RouteInformation;
     using RouterInformation = router::RouterInformation;
+    using ReachableStops = std::vector<router::ReachableStop>;
+    using StopsDistances = std::vector<transport_catalogue::detail::StopDistance>;
 
 public:
         
@@ -41,9 +43,30 @@ public:
     // Визуализирует карту маршрутов с использованием MapRenderer
     svg::Document RenderMap() const;
 
+    // Выводит карту маршрутов сразу в поток out, не строя svg::Document
+    void RenderMap(std::ostream& out) const;
+
+    // Выводит в поток out часть карты area (запрос MapTile), отрисовывая только попадающие в нее объекты
+    void RenderMap(const renderer::MapArea& area, std::ostream& out) const;
+
     // Возвращает иформацию по маршруту из TransportRoute
     const std::optional<RouterInformation> GetRouterInfo(std::string_view from, std::string_view to) const;
 
+    // Возвращает маршрут между точками from и to с пешим путем до ближайших к ним остановок
+    const std::optional<RouterInformation> GetRouterInfo(geo::Coordinates from, geo::Coordinates to) const;
+
+    // Возвращает остановки, достижимые от остановки from не более чем за max_time минут (запрос Isochrone)
+    const std::optional<ReachableStops> GetReachableStops(std::string_view from, double max_time) const;
+
+    // Возвращает count ближайших к точке center остановок (запрос NearestStops)
+    StopsDistances GetNearestStops(geo::Coordinates center, size_t count) const;
+
+    // Возвращает остановки не дальше radius метров от точки center (запрос StopsInRadius)
+    StopsDistances GetStopsWithinRadius(geo::Coordinates center, double radius) const;
+
+    // Возвращает остановки в прямоугольнике координат [min_corner, max_corner] (запрос StopsInBox)
+    std::vector<const domain::Stop*> GetStopsInBox(geo::Coordinates min_corner, geo::Coordinates max_corner) const;
+
 private:
 
      // RequestHandler использует агрегацию объектов "Транспортный Справочник", "Визуализатор Карты" и "Транспортный маршрутизатор"
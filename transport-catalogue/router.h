@@ -29,6 +29,14 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Учитывает ребра edge_ids, добавленные в граф или уменьшившие вес после построения таблицы,
+    // а также добавленные в граф вершины. Пересчитываются только пути через концы этих ребер:
+    // O(K * V^2), где K - количество различных концов ребер
+    void UpdateEdges(const std::vector<EdgeId>& edge_ids);
+
+    // Заново строит таблицу по текущему состоянию графа (например, если вес ребер увеличился)
+    void Rebuild();
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -41,18 +49,38 @@ private:
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
             routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
-                    throw std::domain_error("Edges' weights should be non-negative");
-                }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
-                }
+                InitializeEdgeRoute(edge_id);
             }
         }
     }
 
+    void InitializeEdgeRoute(EdgeId edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        auto& route_internal_data = routes_internal_data_[edge.from][edge.to];
+        if (!route_internal_data || route_internal_data->weight > edge.weight) {
+            route_internal_data = RouteInternalData{edge.weight, edge_id};
+        }
+    }
+
+    // Добавляет в таблицу строки и столбцы для вершин, добавленных в граф
+    void ResizeRoutesInternalData() {
+        const size_t old_vertex_count = routes_internal_data_.size();
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (old_vertex_count == vertex_count) {
+            return;
+        }
+        routes_internal_data_.resize(vertex_count);
+        for (auto& routes : routes_internal_data_) {
+            routes.resize(vertex_count);
+        }
+        for (VertexId vertex = old_vertex_count; vertex < vertex_count; ++vertex) {
+            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        }
+    }
+
     void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
                     const RouteInternalData& route_to) {
         auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
@@ -94,6 +122,43 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
+template <typename Weight>
+void Router<Weight>::UpdateEdges(const std::vector<EdgeId>& edge_ids) {
+    ResizeRoutesInternalData();
+
+    // Таблица уже содержит кратчайшие пути в прежнем графе, поэтому любой новый кратчайший путь
+    // составлен из прежних путей и новых ребер, соединенных в концах этих ребер. Значит,
+    // достаточно шагов алгоритма Флойда-Уоршелла только через концы новых ребер
+    std::vector<VertexId> vertices_through;
+    vertices_through.reserve(edge_ids.size() * 2);
+    for (const EdgeId edge_id : edge_ids) {
+        InitializeEdgeRoute(edge_id);
+        const auto& edge = graph_.GetEdge(edge_id);
+        vertices_through.push_back(edge.from);
+        vertices_through.push_back(edge.to);
+    }
+    std::sort(vertices_through.begin(), vertices_through.end());
+    vertices_through.erase(std::unique(vertices_through.begin(), vertices_through.end()),
+                           vertices_through.end());
+
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (const VertexId vertex_through : vertices_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    }
+}
+
+template <typename Weight>
+void Router<Weight>::Rebuild() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    routes_internal_data_.assign(vertex_count,
+                                 std::vector<std::optional<RouteInternalData>>(vertex_count));
+    InitializeRoutesInternalData(graph_);
+
+    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    }
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
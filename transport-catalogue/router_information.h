@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace router {
+
+enum RouteType { WAIT, BUS, WALK };
+
+struct RouteItem
+{
+	RouteType type;
+	int span_count = 0;
+	double time = 0.0;
+	std::string_view data;
+};
+
+struct RouterInformation {
+	double total_time = 0.0;
+	std::vector<RouteItem> items;
+};
+
+// Остановка, достижимая за ограниченное время, и наименьшее время пути до нее
+struct ReachableStop {
+	std::string_view stop_name;
+	double time = 0.0;
+};
+
+// Остановка, с которой может начинаться или которой может заканчиваться маршрут между точками,
+// и время пешего пути между ней и точкой
+struct RouteEndpoint {
+	std::string_view stop_name;
+	double walk_time = 0.0;
+};
+
+// Время маршрута - сумма времен его элементов в порядке следования. Так время считают режимы A*, ALT
+// и RAPTOR, поэтому для одного и того же маршрута их ответы совпадают. В режиме all_pairs время -
+// вес из таблицы маршрутов, сложенный в другом порядке, и может отличаться в последнем знаке
+inline double ComputeTotalTime(const std::vector<RouteItem>& items) {
+	return std::accumulate(items.begin(), items.end(), 0.0, [](double time, const RouteItem& item) {
+		return time + item.time;
+		});
+}
+
+// Добавляет в начало и конец маршрута route пеший путь до остановки source и от остановки target
+// и пересчитывает total_time
+inline void InsertWalkItems(RouterInformation& route, const RouteEndpoint& source, const RouteEndpoint& target) {
+	route.items.insert(route.items.begin(), RouteItem{
+		.type = RouteType::WALK,
+		.time = source.walk_time,
+		.data = source.stop_name
+		});
+	route.items.push_back(RouteItem{
+		.type = RouteType::WALK,
+		.time = target.walk_time,
+		.data = target.stop_name
+		});
+	route.total_time = ComputeTotalTime(route.items);
+}
+
+// Упорядочивает достижимые остановки по времени пути, а при равном времени - по названию
+inline void SortReachableStops(std::vector<ReachableStop>& stops) {
+	std::sort(stops.begin(), stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+		return std::tie(lhs.time, lhs.stop_name) < std::tie(rhs.time, rhs.stop_name);
+		});
+}
+
+} // namespace router
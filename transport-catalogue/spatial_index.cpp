@@ -0,0 +1,385 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace transport_catalogue {
+
+	namespace detail {
+
+		namespace {
+
+			// Те же константы, что и в geo::ComputeDistance
+			const double DR = 3.1415926535 / 180.;
+			const double EARTH_RADIUS = 6371000;
+
+			// Запас для длины хорды, покрывающий погрешность acos в geo::ComputeDistance
+			const double CHORD_MARGIN = 1e-6;
+
+			double SquaredDistance(const std::array<double, 3>& lhs, const std::array<double, 3>& rhs) {
+				double result = 0.0;
+				for (size_t axis = 0; axis < 3; ++axis) {
+					result += (lhs[axis] - rhs[axis]) * (lhs[axis] - rhs[axis]);
+				}
+				return result;
+			}
+
+			// Возвращает квадрат хорды, увеличенной на CHORD_MARGIN
+			double WithMargin(double squared_chord) {
+				const double chord = std::sqrt(squared_chord) + CHORD_MARGIN;
+				return chord * chord;
+			}
+
+			// Элементы [first_new, size) образуют новый уровень, который сливается с последними уровнями,
+			// пока они не больше его. Возвращает начало получившегося уровня
+			size_t AppendLevel(std::vector<size_t>& level_begins, size_t first_new, size_t size) {
+				size_t begin = first_new;
+				while (!level_begins.empty() && begin - level_begins.back() <= size - begin) {
+					begin = level_begins.back();
+					level_begins.pop_back();
+				}
+				level_begins.push_back(begin);
+				return begin;
+			}
+
+			// Вызывает callback(begin, end) для отрезка каждого уровня
+			template <typename Callback>
+			void ForEachLevel(const std::vector<size_t>& level_begins, size_t size, Callback callback) {
+				for (size_t i = 0; i < level_begins.size(); ++i) {
+					callback(level_begins[i], (i + 1 < level_begins.size()) ? level_begins[i + 1] : size);
+				}
+			}
+
+		} // namespace
+
+		StopsSpatialIndex::StopsSpatialIndex(std::span<const domain::Stop* const> stops) {
+			Add(stops);
+		}
+
+		void StopsSpatialIndex::Add(std::span<const domain::Stop* const> stops) {
+			if (stops.empty()) {
+				return;
+			}
+			const size_t first_new = items_.size();
+			items_.reserve(first_new + stops.size());
+			for (const auto stop : stops) {
+				items_.push_back({ ToPoint(stop->coordinates), stop });
+			}
+			nodes_.resize(items_.size());
+			Build(AppendLevel(level_begins_, first_new, items_.size()), items_.size());
+		}
+
+		StopsSpatialIndex::Point StopsSpatialIndex::ToPoint(geo::Coordinates coordinates) {
+			const double lat = coordinates.lat * DR;
+			const double lng = coordinates.lng * DR;
+			return { std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat) };
+		}
+
+		void StopsSpatialIndex::Build(size_t begin, size_t end) {
+			if (begin >= end) {
+				return;
+			}
+			const size_t middle = begin + (end - begin) / 2;
+			Node& node = nodes_[middle];
+
+			node.min_point = node.max_point = items_[begin].point;
+			node.min_coordinates = node.max_coordinates = items_[begin].stop->coordinates;
+			for (size_t i = begin + 1; i < end; ++i) {
+				const Item& item = items_[i];
+				for (size_t axis = 0; axis < 3; ++axis) {
+					node.min_point[axis] = std::min(node.min_point[axis], item.point[axis]);
+					node.max_point[axis] = std::max(node.max_point[axis], item.point[axis]);
+				}
+				node.min_coordinates.lat = std::min(node.min_coordinates.lat, item.stop->coordinates.lat);
+				node.min_coordinates.lng = std::min(node.min_coordinates.lng, item.stop->coordinates.lng);
+				node.max_coordinates.lat = std::max(node.max_coordinates.lat, item.stop->coordinates.lat);
+				node.max_coordinates.lng = std::max(node.max_coordinates.lng, item.stop->coordinates.lng);
+			}
+
+			// Делим по оси наибольшей протяженности
+			node.axis = 0;
+			for (uint8_t axis = 1; axis < 3; ++axis) {
+				if (node.max_point[axis] - node.min_point[axis] > node.max_point[node.axis] - node.min_point[node.axis]) {
+					node.axis = axis;
+				}
+			}
+			const uint8_t axis = node.axis;
+			std::nth_element(items_.begin() + begin, items_.begin() + middle, items_.begin() + end,
+				[axis](const Item& lhs, const Item& rhs) { return lhs.point[axis] < rhs.point[axis]; });
+
+			Build(begin, middle);
+			Build(middle + 1, end);
+		}
+
+		double StopsSpatialIndex::SquaredDistanceToNode(const Point& point, const Node& node) {
+			double result = 0.0;
+			for (size_t axis = 0; axis < 3; ++axis) {
+				const double delta = std::max({ node.min_point[axis] - point[axis], 0.0, point[axis] - node.max_point[axis] });
+				result += delta * delta;
+			}
+			return result;
+		}
+
+		void StopsSpatialIndex::CollectWithinChord(size_t begin, size_t end, const Point& center,
+			double squared_chord, std::vector<size_t>& result) const
+		{
+			if (begin >= end) {
+				return;
+			}
+			const size_t middle = begin + (end - begin) / 2;
+			if (SquaredDistanceToNode(center, nodes_[middle]) > squared_chord) {
+				return;
+			}
+			if (SquaredDistance(center, items_[middle].point) <= squared_chord) {
+				result.push_back(middle);
+			}
+			CollectWithinChord(begin, middle, center, squared_chord, result);
+			CollectWithinChord(middle + 1, end, center, squared_chord, result);
+		}
+
+		double StopsSpatialIndex::FindNearestSquaredChord(const Point& center, size_t count) const {
+			// Квадраты хорд до count ближайших найденных остановок, на вершине - наибольший
+			std::priority_queue<double> nearest;
+
+			auto search = [&](const auto& self, size_t begin, size_t end) -> void {
+				if (begin >= end) {
+					return;
+				}
+				const size_t middle = begin + (end - begin) / 2;
+				const Node& node = nodes_[middle];
+				if (nearest.size() == count && SquaredDistanceToNode(center, node) > nearest.top()) {
+					return;
+				}
+
+				const double squared_distance = SquaredDistance(center, items_[middle].point);
+				if (nearest.size() < count) {
+					nearest.push(squared_distance);
+				}
+				else if (squared_distance < nearest.top()) {
+					nearest.pop();
+					nearest.push(squared_distance);
+				}
+
+				// Сначала обходим половину, в которой лежит центр
+				if (center[node.axis] < items_[middle].point[node.axis]) {
+					self(self, begin, middle);
+					self(self, middle + 1, end);
+				}
+				else {
+					self(self, middle + 1, end);
+					self(self, begin, middle);
+				}
+			};
+			ForEachLevel(level_begins_, items_.size(), [&search](size_t begin, size_t end) {
+				search(search, begin, end);
+				});
+
+			return nearest.top();
+		}
+
+		void StopsSpatialIndex::CollectInBox(size_t begin, size_t end, geo::Coordinates min_corner,
+			geo::Coordinates max_corner, std::vector<const domain::Stop*>& result) const
+		{
+			if (begin >= end) {
+				return;
+			}
+			const size_t middle = begin + (end - begin) / 2;
+			const Node& node = nodes_[middle];
+			if (node.max_coordinates.lat < min_corner.lat || node.min_coordinates.lat > max_corner.lat
+				|| node.max_coordinates.lng < min_corner.lng || node.min_coordinates.lng > max_corner.lng) {
+				return;
+			}
+
+			const geo::Coordinates& coordinates = items_[middle].stop->coordinates;
+			if (coordinates.lat >= min_corner.lat && coordinates.lat <= max_corner.lat
+				&& coordinates.lng >= min_corner.lng && coordinates.lng <= max_corner.lng) {
+				result.push_back(items_[middle].stop);
+			}
+			CollectInBox(begin, middle, min_corner, max_corner, result);
+			CollectInBox(middle + 1, end, min_corner, max_corner, result);
+		}
+
+		std::vector<StopDistance> StopsSpatialIndex::RefineCandidates(const std::vector<size_t>& candidates,
+			geo::Coordinates center, double max_distance) const
+		{
+			const geo::LatitudeTrig center_trig = geo::ComputeLatitudeTrig(center);
+
+			std::vector<StopDistance> result;
+			result.reserve(candidates.size());
+			for (const size_t index : candidates) {
+				const domain::Stop* stop = items_[index].stop;
+				const double distance = geo::ComputeDistance(center, center_trig, stop->coordinates, stop->latitude_trig);
+				if (distance <= max_distance) {
+					result.push_back({ stop, distance });
+				}
+			}
+			std::sort(result.begin(), result.end(), [](const StopDistance& lhs, const StopDistance& rhs) {
+				return std::tie(lhs.distance, lhs.stop->name) < std::tie(rhs.distance, rhs.stop->name);
+				});
+			return result;
+		}
+
+		std::vector<StopDistance> StopsSpatialIndex::FindNearest(geo::Coordinates center, size_t count) const {
+			if (count == 0 || items_.empty()) {
+				return {};
+			}
+			const Point point = ToPoint(center);
+			const double squared_chord = FindNearestSquaredChord(point, std::min(count, items_.size()));
+
+			// Остановки на той же границе тоже отбираются, чтобы порядок при равных расстояниях
+			// определялся названием, а не устройством дерева
+			std::vector<size_t> candidates;
+			ForEachLevel(level_begins_, items_.size(), [&](size_t begin, size_t end) {
+				CollectWithinChord(begin, end, point, WithMargin(squared_chord), candidates);
+				});
+
+			auto result = RefineCandidates(candidates, center, std::numeric_limits<double>::infinity());
+			if (result.size() > count) {
+				result.resize(count);
+			}
+			return result;
+		}
+
+		std::vector<StopDistance> StopsSpatialIndex::FindWithinRadius(geo::Coordinates center, double radius) const {
+			if (radius < 0 || items_.empty()) {
+				return {};
+			}
+			const double angle = std::min(radius / EARTH_RADIUS, 3.1415926535);
+			const double chord = 2 * std::sin(angle / 2);
+
+			const Point point = ToPoint(center);
+			std::vector<size_t> candidates;
+			ForEachLevel(level_begins_, items_.size(), [&](size_t begin, size_t end) {
+				CollectWithinChord(begin, end, point, WithMargin(chord * chord), candidates);
+				});
+			return RefineCandidates(candidates, center, radius);
+		}
+
+		std::vector<const domain::Stop*> StopsSpatialIndex::FindInBox(geo::Coordinates min_corner,
+			geo::Coordinates max_corner) const
+		{
+			std::vector<const domain::Stop*> result;
+			ForEachLevel(level_begins_, items_.size(), [&](size_t begin, size_t end) {
+				CollectInBox(begin, end, min_corner, max_corner, result);
+				});
+			std::sort(result.begin(), result.end(), [](const domain::Stop* lhs, const domain::Stop* rhs) {
+				return lhs->name < rhs->name;
+				});
+			return result;
+		}
+
+		BusSegmentsSpatialIndex::BusSegmentsSpatialIndex(std::span<const domain::Bus* const> buses) {
+			Add(buses);
+		}
+
+		void BusSegmentsSpatialIndex::Add(std::span<const domain::Bus* const> buses) {
+			const size_t first_new = segments_.size();
+			for (const auto bus : buses) {
+				const auto& stops = bus->bus_stops;
+				if (stops.size() == 1) {
+					segments_.push_back({ bus, stops[0]->coordinates, stops[0]->coordinates });
+				}
+				for (size_t i = 1; i < stops.size(); ++i) {
+					segments_.push_back({ bus, stops[i - 1]->coordinates, stops[i]->coordinates });
+				}
+			}
+			if (segments_.size() == first_new) {
+				return;
+			}
+			nodes_.resize(segments_.size());
+			Build(AppendLevel(level_begins_, first_new, segments_.size()), segments_.size());
+		}
+
+		void BusSegmentsSpatialIndex::Build(size_t begin, size_t end) {
+			if (begin >= end) {
+				return;
+			}
+			const size_t middle = begin + (end - begin) / 2;
+			Node& node = nodes_[middle];
+
+			node.min_corner = node.max_corner = segments_[begin].from;
+			for (size_t i = begin; i < end; ++i) {
+				for (const geo::Coordinates& point : { segments_[i].from, segments_[i].to }) {
+					node.min_corner.lat = std::min(node.min_corner.lat, point.lat);
+					node.min_corner.lng = std::min(node.min_corner.lng, point.lng);
+					node.max_corner.lat = std::max(node.max_corner.lat, point.lat);
+					node.max_corner.lng = std::max(node.max_corner.lng, point.lng);
+				}
+			}
+
+			// Делим по оси наибольшей протяженности, сравнивая середины отрезков
+			node.is_lat_axis = node.max_corner.lat - node.min_corner.lat > node.max_corner.lng - node.min_corner.lng;
+			const bool is_lat_axis = node.is_lat_axis;
+			std::nth_element(segments_.begin() + begin, segments_.begin() + middle, segments_.begin() + end,
+				[is_lat_axis](const Segment& lhs, const Segment& rhs) {
+					return (is_lat_axis) ? lhs.from.lat + lhs.to.lat < rhs.from.lat + rhs.to.lat
+						: lhs.from.lng + lhs.to.lng < rhs.from.lng + rhs.to.lng;
+				});
+
+			Build(begin, middle);
+			Build(middle + 1, end);
+		}
+
+		bool BusSegmentsSpatialIndex::IntersectsBox(const Segment& segment, geo::Coordinates min_corner,
+			geo::Coordinates max_corner)
+		{
+			// Отрезок from + t * (to - from), t из [t_enter, t_exit], сужается до части внутри полосы каждой оси
+			double t_enter = 0.0;
+			double t_exit = 1.0;
+			auto clip = [&t_enter, &t_exit](double from, double delta, double min_value, double max_value) {
+				if (delta == 0.0) {
+					return from >= min_value && from <= max_value;
+				}
+				double t_min = (min_value - from) / delta;
+				double t_max = (max_value - from) / delta;
+				if (t_min > t_max) {
+					std::swap(t_min, t_max);
+				}
+				t_enter = std::max(t_enter, t_min);
+				t_exit = std::min(t_exit, t_max);
+				return t_enter <= t_exit;
+			};
+			return clip(segment.from.lat, segment.to.lat - segment.from.lat, min_corner.lat, max_corner.lat)
+				&& clip(segment.from.lng, segment.to.lng - segment.from.lng, min_corner.lng, max_corner.lng);
+		}
+
+		void BusSegmentsSpatialIndex::CollectInBox(size_t begin, size_t end, geo::Coordinates min_corner,
+			geo::Coordinates max_corner, std::vector<const domain::Bus*>& result) const
+		{
+			if (begin >= end) {
+				return;
+			}
+			const size_t middle = begin + (end - begin) / 2;
+			const Node& node = nodes_[middle];
+			if (node.max_corner.lat < min_corner.lat || node.min_corner.lat > max_corner.lat
+				|| node.max_corner.lng < min_corner.lng || node.min_corner.lng > max_corner.lng) {
+				return;
+			}
+
+			if (IntersectsBox(segments_[middle], min_corner, max_corner)) {
+				result.push_back(segments_[middle].bus);
+			}
+			CollectInBox(begin, middle, min_corner, max_corner, result);
+			CollectInBox(middle + 1, end, min_corner, max_corner, result);
+		}
+
+		std::vector<const domain::Bus*> BusSegmentsSpatialIndex::FindInBox(geo::Coordinates min_corner,
+			geo::Coordinates max_corner) const
+		{
+			std::vector<const domain::Bus*> result;
+			ForEachLevel(level_begins_, segments_.size(), [&](size_t begin, size_t end) {
+				CollectInBox(begin, end, min_corner, max_corner, result);
+				});
+			std::sort(result.begin(), result.end(), [](const domain::Bus* lhs, const domain::Bus* rhs) {
+				return lhs->name < rhs->name;
+				});
+			result.erase(std::unique(result.begin(), result.end()), result.end());
+			return result;
+		}
+
+	} // namespace detail
+
+} // namespace transport_catalogue
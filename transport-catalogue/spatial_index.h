@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "domain.h"
+#include "geo.h"
+
+namespace transport_catalogue {
+
+	namespace detail {
+
+		// Остановка и расстояние до нее от точки запроса
+		struct StopDistance {
+			const domain::Stop* stop = nullptr;
+			double distance = 0.0;
+		};
+
+		/*
+		 * Пространственный индекс остановок - сбалансированное k-d дерево.
+		 * Координаты остановок переводятся в точки единичной сферы в трехмерном пространстве:
+		 * длина хорды между такими точками монотонно связана с расстоянием по поверхности Земли,
+		 * поэтому отсечение ветвей по хорде точное, а geo::ComputeDistance вычисляется только
+		 * для отобранных кандидатов. Узлы дополнительно хранят границы широт и долгот своих остановок
+		 * для запросов по прямоугольнику.
+		 * Добавление выполняется логарифмическим методом: индекс состоит из нескольких деревьев
+		 * (уровней) убывающего размера, новые остановки образуют новый уровень, который сливается
+		 * с последними уровнями не большего размера. Каждая остановка перестраивается O(log N) раз,
+		 * а запрос обходит O(log N) деревьев
+		 */
+		class StopsSpatialIndex {
+		public:
+
+			StopsSpatialIndex() = default;
+			explicit StopsSpatialIndex(std::span<const domain::Stop* const> stops);
+
+			// Добавляет остановки stops в индекс без перестроения уже построенных больших уровней
+			void Add(std::span<const domain::Stop* const> stops);
+
+			// Возвращает count ближайших к точке center остановок в порядке возрастания расстояния
+			// (при равном расстоянии - по названию)
+			std::vector<StopDistance> FindNearest(geo::Coordinates center, size_t count) const;
+
+			// Возвращает остановки на расстоянии не больше radius метров от точки center
+			// в порядке возрастания расстояния (при равном расстоянии - по названию)
+			std::vector<StopDistance> FindWithinRadius(geo::Coordinates center, double radius) const;
+
+			// Возвращает остановки, координаты которых лежат в прямоугольнике [min_corner, max_corner],
+			// в порядке названий
+			std::vector<const domain::Stop*> FindInBox(geo::Coordinates min_corner, geo::Coordinates max_corner) const;
+
+		private:
+
+			using Point = std::array<double, 3>;
+
+			// Узел дерева соответствует отрезку [begin, end) массива items_,
+			// его остановка лежит в середине отрезка. Узлы хранятся по индексу середины
+			struct Node {
+				uint8_t axis = 0;
+				// Границы точек поддерева в трехмерном пространстве
+				Point min_point{};
+				Point max_point{};
+				// Границы координат остановок поддерева
+				geo::Coordinates min_coordinates{};
+				geo::Coordinates max_coordinates{};
+			};
+
+			struct Item {
+				Point point{};
+				const domain::Stop* stop = nullptr;
+			};
+
+			std::vector<Item> items_;
+			std::vector<Node> nodes_;
+			// Начала уровней в items_: уровень i - дерево на отрезке [level_begins_[i], level_begins_[i + 1])
+			std::vector<size_t> level_begins_;
+
+			static Point ToPoint(geo::Coordinates coordinates);
+
+			// Строит поддерево на отрезке [begin, end)
+			void Build(size_t begin, size_t end);
+
+			// Квадрат расстояния от точки до границ поддерева узла (0, если точка внутри)
+			static double SquaredDistanceToNode(const Point& point, const Node& node);
+
+			// Добавляет в result индексы остановок поддерева [begin, end), квадрат хорды до которых
+			// не больше squared_chord
+			void CollectWithinChord(size_t begin, size_t end, const Point& center, double squared_chord,
+				std::vector<size_t>& result) const;
+
+			// Возвращает квадрат хорды до count-й ближайшей к center остановки
+			double FindNearestSquaredChord(const Point& center, size_t count) const;
+
+			void CollectInBox(size_t begin, size_t end, geo::Coordinates min_corner, geo::Coordinates max_corner,
+				std::vector<const domain::Stop*>& result) const;
+
+			// Вычисляет расстояния до кандидатов, отбрасывает дальше max_distance и упорядочивает
+			std::vector<StopDistance> RefineCandidates(const std::vector<size_t>& candidates,
+				geo::Coordinates center, double max_distance) const;
+		};
+
+		/*
+		 * Пространственный индекс перегонов маршрутов - отрезков между соседними остановками
+		 * в координатах широта/долгота, в которых карта строится линейной проекцией.
+		 * Сбалансированные k-d деревья по серединам отрезков, узлы хранят границы отрезков поддерева.
+		 * Маршруты добавляются логарифмическим методом, как остановки в StopsSpatialIndex
+		 */
+		class BusSegmentsSpatialIndex {
+		public:
+
+			BusSegmentsSpatialIndex() = default;
+			explicit BusSegmentsSpatialIndex(std::span<const domain::Bus* const> buses);
+
+			// Добавляет перегоны маршрутов buses в индекс без перестроения уже построенных больших уровней
+			void Add(std::span<const domain::Bus* const> buses);
+
+			// Возвращает маршруты, хотя бы один перегон которых пересекает прямоугольник [min_corner, max_corner],
+			// в порядке названий. Маршрут из одной остановки учитывается, если она лежит в прямоугольнике
+			std::vector<const domain::Bus*> FindInBox(geo::Coordinates min_corner, geo::Coordinates max_corner) const;
+
+		private:
+
+			struct Node {
+				bool is_lat_axis = false;
+				// Границы отрезков поддерева
+				geo::Coordinates min_corner{};
+				geo::Coordinates max_corner{};
+			};
+
+			struct Segment {
+				const domain::Bus* bus = nullptr;
+				geo::Coordinates from{};
+				geo::Coordinates to{};
+			};
+
+			std::vector<Segment> segments_;
+			std::vector<Node> nodes_;
+			// Начала уровней в segments_, как в StopsSpatialIndex
+			std::vector<size_t> level_begins_;
+
+			// Строит поддерево на отрезке [begin, end) массива segments_
+			void Build(size_t begin, size_t end);
+
+			void CollectInBox(size_t begin, size_t end, geo::Coordinates min_corner, geo::Coordinates max_corner,
+				std::vector<const domain::Bus*>& result) const;
+
+			// Проверяет, пересекает ли отрезок прямоугольник (отсечение Лианга - Барски)
+			static bool IntersectsBox(const Segment& segment, geo::Coordinates min_corner, geo::Coordinates max_corner);
+		};
+
+	} // namespace detail
+
+} // namespace transport_catalogue
@@ -0,0 +1,31 @@
+#include "string_pool.h"
+
+#include <algorithm>
+
+namespace transport_catalogue {
+
+	namespace detail {
+
+		StringPool::Handle StringPool::Intern(std::string_view str) {
+			if (const auto handle = Find(str)) {
+				return *handle;
+			}
+			const Handle handle = static_cast<Handle>(strings_.size());
+			char* data = static_cast<char*>(buffer_.allocate(str.size(), alignof(char)));
+			std::copy(str.begin(), str.end(), data);
+			strings_.emplace_back(data, str.size());
+			string_to_handle_.insert({ strings_.back(), handle });
+			return handle;
+		}
+
+		std::optional<StringPool::Handle> StringPool::Find(std::string_view str) const {
+			const auto iter = string_to_handle_.find(str);
+			if (iter == string_to_handle_.end()) {
+				return std::nullopt;
+			}
+			return iter->second;
+		}
+
+	} // namespace detail
+
+} // namespace transport_catalogue
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace transport_catalogue {
+
+	namespace detail {
+
+		/*
+		 * Пул строк (интернер): каждая строка хранится в единственном экземпляре
+		 * и получает целочисленный дескриптор. Символы строк записываются подряд в блоки
+		 * монотонного буфера и не перемещаются при добавлении новых строк,
+		 * поэтому string_view на строки пула действительны все время жизни пула
+		 */
+		class StringPool {
+		public:
+
+			using Handle = uint32_t;
+
+			// Добавляет строку str в пул, если ее там еще нет, и возвращает ее дескриптор
+			Handle Intern(std::string_view str);
+
+			// Возвращает дескриптор строки str или std::nullopt, если ее нет в пуле
+			std::optional<Handle> Find(std::string_view str) const;
+
+			// Возвращает строку пула по дескриптору
+			std::string_view GetString(Handle handle) const { return strings_[handle]; }
+
+			size_t GetSize() const { return strings_.size(); }
+
+		private:
+
+			std::pmr::monotonic_buffer_resource buffer_;
+			std::vector<std::string_view> strings_;
+			std::unordered_map<std::string_view, Handle> string_to_handle_;
+		};
+
+	} // namespace detail
+
+} // namespace transport_catalogue
@@ -1,18 +1,13 @@
 #include "svg.h"
 
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+
 namespace svg {
 
     using namespace std::literals;
 
-    void Object::Render(const RenderContext& context) const {
-        context.RenderIndent();
-
-        // Делегируем вывод тега своим подклассам
-        RenderObject(context);
-
-        context.out << std::endl;
-    }
-
     std::ostream& operator<<(std::ostream& os, const StrokeLineCap& cap) {
         switch (cap)
         {
@@ -51,6 +46,14 @@ namespace svg {
         return os;
     }
 
+    void RenderNumber(std::ostream& out, double value) {
+        // Достаточно для любого double в формате %g с точностью до 17 знаков
+        char buffer[32];
+        const int precision = std::min(static_cast<int>(out.precision()), 17);
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, precision);
+        out.write(buffer, result.ptr - buffer);
+    }
+
     void ColorPrinter::operator()(std::monostate) const {
         out << "none"sv;
     }
@@ -68,8 +71,9 @@ namespace svg {
     void ColorPrinter::operator()(const Rgba& rgba) const {
         out << "rgba("sv << static_cast<int>(rgba.red) << ','
             << static_cast<int>(rgba.green) << ','
-            << static_cast<int>(rgba.blue) << ','
-            << rgba.opacity << ')';
+            << static_cast<int>(rgba.blue) << ',';
+        RenderNumber(out, rgba.opacity);
+        out << ')';
     }
 
     std::ostream& operator<<(std::ostream& os, const Color& color) {
@@ -78,6 +82,42 @@ namespace svg {
         return os;
     }
 
+    void RenderPathAttrs(std::ostream& out, const PathAttrs& attrs) {
+        if (attrs.fill_color) {
+            out << " fill=\""sv << *attrs.fill_color << "\""sv;
+        }
+        if (attrs.stroke_color) {
+            out << " stroke=\""sv << *attrs.stroke_color << "\""sv;
+        }
+        if (attrs.stroke_width) {
+            out << " stroke-width=\""sv;
+            RenderNumber(out, *attrs.stroke_width);
+            out << "\""sv;
+        }
+        if (attrs.stroke_linecap) {
+            out << " stroke-linecap=\""sv << *attrs.stroke_linecap << "\""sv;
+        }
+        if (attrs.stroke_linejoin) {
+            out << " stroke-linejoin=\""sv << *attrs.stroke_linejoin << "\""sv;
+        }
+    }
+
+    std::string FormatPathAttrs(const PathAttrs& attrs, std::streamsize precision) {
+        std::ostringstream out;
+        out.precision(precision);
+        RenderPathAttrs(out, attrs);
+        return std::move(out).str();
+    }
+
+    Color ToFormattedColor(const Color& color) {
+        if (std::holds_alternative<std::string>(color)) {
+            return color;
+        }
+        std::ostringstream out;
+        out << color;
+        return out.str();
+    }
+
     // ---------- Circle ------------------
 
     Circle& Circle::SetCenter(Point center) {
@@ -92,8 +132,13 @@ namespace svg {
 
     void Circle::RenderObject(const RenderContext& context) const {
         auto& out = context.out;
-        out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-        out << "r=\""sv << radius_ << "\""sv;
+        out << "<circle cx=\""sv;
+        RenderNumber(out, center_.x);
+        out << "\" cy=\""sv;
+        RenderNumber(out, center_.y);
+        out << "\" r=\""sv;
+        RenderNumber(out, radius_);
+        out << "\""sv;
         RenderAttrs(context.out);
         out << "/>"sv;
     }
@@ -113,7 +158,9 @@ namespace svg {
             if (!is_first) {
                 out << ' ';
             }
-            out << point.x << ',' << point.y;
+            RenderNumber(out, point.x);
+            out << ',';
+            RenderNumber(out, point.y);
             is_first = false;
         }
         out << "\""sv;
@@ -183,8 +230,15 @@ namespace svg {
 
     void Text::RenderObject(const RenderContext& context) const {
         auto& out = context.out;
-        out << "<text "sv << "x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" "sv;
-        out << "dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\""sv;
+        out << "<text x=\""sv;
+        RenderNumber(out, pos_.x);
+        out << "\" y=\""sv;
+        RenderNumber(out, pos_.y);
+        out << "\" dx=\""sv;
+        RenderNumber(out, offset_.x);
+        out << "\" dy=\""sv;
+        RenderNumber(out, offset_.y);
+        out << "\""sv;
         out << " font-size=\""sv << size_ << "\""sv;
         if (!font_family_.empty()) {
             out << " font-family=\""sv << font_family_ << "\""sv;
@@ -199,17 +253,51 @@ namespace svg {
 
     // ---------- Document ---------------
 
-    void Document::AddPtr(std::unique_ptr<Object>&& obj) {
-        objects_.push_back(std::move(obj));
+    void Document::AddObject(AnyObject&& object) {
+        objects_.push_back(std::move(object));
     }
 
+    namespace {
+
+        void RenderHeader(std::ostream& out) {
+            out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+            out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+        }
+
+        void RenderAnyObject(const AnyObject& object, std::ostream& out) {
+            const RenderContext context{ out, 0, 2 };
+            std::visit([&context](const auto& obj) { obj.Render(context); }, object);
+        }
+
+        void RenderFooter(std::ostream& out) {
+            out << "</svg>";
+        }
+
+    } // namespace
+
     void Document::Render(std::ostream& out) const {
-        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
-        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
-        for (const auto& obj : objects_) {
-            obj.get()->Render({ out, 0, 2 });
+        RenderHeader(out);
+        for (const auto& object : objects_) {
+            RenderAnyObject(object, out);
         }
-        out << "</svg>";
+        RenderFooter(out);
+    }
+
+    // ---------- ObjectStream -----------
+
+    void ObjectStream::AddObject(AnyObject&& object) {
+        RenderAnyObject(object, out_);
+    }
+
+    // ---------- StreamDocument ---------
+
+    StreamDocument::StreamDocument(std::ostream& out)
+        : ObjectStream(out) {
+        RenderHeader(out_);
+    }
+
+    void StreamDocument::Finish() {
+        RenderFooter(out_);
     }
 
 }  // namespace svg
\ No newline at end of file
@@ -2,9 +2,9 @@
 
 #include <cstdint>
 #include <iostream>
-#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -65,6 +65,10 @@ namespace svg {
 
     using Color = std::variant<std::monostate, std::string, Rgb, Rgba>;
 
+    // Выводит число так же, как operator<< с текущей точностью потока (формат %g),
+    // но через std::to_chars без обращения к локали
+    void RenderNumber(std::ostream& out, double value);
+
     // Объявив в заголовочном файле константу со спецификатором inline,
     // мы сделаем так, что она будет одной на все единицы трансляции,
     // которые подключают этот заголовок.
@@ -82,6 +86,10 @@ namespace svg {
 
     std::ostream& operator<<(std::ostream& os, const Color& color);
 
+    // Возвращает цвет, заданный строкой с его svg-представлением: такой цвет выводится
+    // без форматирования чисел, результат вывода совпадает с выводом color
+    Color ToFormattedColor(const Color& color);
+
     enum class StrokeLineCap {
         BUTT,
         ROUND,
@@ -99,27 +107,55 @@ namespace svg {
     std::ostream& operator<<(std::ostream& os, const StrokeLineJoin& join);
     std::ostream& operator<<(std::ostream& os, const StrokeLineCap& cap);
 
+    // Общие для всех путей атрибуты fill и stroke
+    struct PathAttrs {
+        std::optional<Color> fill_color = std::nullopt;
+        std::optional<Color> stroke_color = std::nullopt;
+        std::optional<double> stroke_width = std::nullopt;
+        std::optional<StrokeLineCap> stroke_linecap = std::nullopt;
+        std::optional<StrokeLineJoin> stroke_linejoin = std::nullopt;
+    };
+
+    // Выводит в поток заданные атрибуты attrs
+    void RenderPathAttrs(std::ostream& out, const PathAttrs& attrs);
+
+    // Возвращает строку, которую RenderPathAttrs выводит в поток с точностью чисел precision.
+    // Атрибуты, общие для многих объектов, форматируются так один раз и задаются объектам
+    // через SetFormattedAttrs
+    std::string FormatPathAttrs(const PathAttrs& attrs, std::streamsize precision);
+
     template <typename Owner>
     class PathProps {
     public:
         Owner& SetFillColor(Color color) {
-            fill_color_ = std::move(color);
+            attrs_.fill_color = std::move(color);
             return AsOwner();
         }
         Owner& SetStrokeColor(Color color) {
-            stroke_color_ = std::move(color);
+            attrs_.stroke_color = std::move(color);
             return AsOwner();
         }
         Owner& SetStrokeWidth(double width) {
-            stroke_width_ = width;
+            attrs_.stroke_width = width;
             return AsOwner();
         }
         Owner& SetStrokeLineCap(StrokeLineCap linecap) {
-            stroke_linecap_ = linecap;
+            attrs_.stroke_linecap = linecap;
             return AsOwner();
         }
         Owner& SetStrokeLineJoin(StrokeLineJoin linejoin) {
-            stroke_linejoin_ = linejoin;
+            attrs_.stroke_linejoin = linejoin;
+            return AsOwner();
+        }
+        Owner& SetAttrs(PathAttrs attrs) {
+            attrs_ = std::move(attrs);
+            return AsOwner();
+        }
+
+        // Задает строку атрибутов, отформатированную FormatPathAttrs: она выводится как есть
+        // перед остальными атрибутами. Объект не копирует строку, она должна существовать до его вывода
+        Owner& SetFormattedAttrs(std::string_view attrs) {
+            formatted_attrs_ = attrs;
             return AsOwner();
         }
 
@@ -128,23 +164,8 @@ namespace svg {
 
         // Метод RenderAttrs выводит в поток общие для всех путей атрибуты fill и stroke
         void RenderAttrs(std::ostream& out) const {
-            using namespace std::literals;
-
-            if (fill_color_) {
-                out << " fill=\""sv << *fill_color_ << "\""sv;
-            }
-            if (stroke_color_) {
-                out << " stroke=\""sv << *stroke_color_ << "\""sv;
-            }
-            if (stroke_width_) {
-                out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
-            }
-            if (stroke_linecap_) {
-                out << " stroke-linecap=\""sv << *stroke_linecap_ << "\""sv;
-            }
-            if (stroke_linejoin_) {
-                out << " stroke-linejoin=\""sv << *stroke_linejoin_ << "\""sv;
-            }
+            out << formatted_attrs_;
+            RenderPathAttrs(out, attrs_);
         }
 
     private:
@@ -154,39 +175,45 @@ namespace svg {
             return static_cast<Owner&>(*this);
         }
 
-        std::optional<Color> fill_color_;
-        std::optional<Color> stroke_color_;
-        std::optional<double> stroke_width_;
-        std::optional<StrokeLineCap> stroke_linecap_;
-        std::optional<StrokeLineJoin> stroke_linejoin_;
+        PathAttrs attrs_;
+        std::string_view formatted_attrs_;
     };
 
     /*
-     * Абстрактный базовый класс Object служит для унифицированного хранения
-     * конкретных тегов SVG-документа
-     * Реализует паттерн "Шаблонный метод" для вывода содержимого тега
+     * Базовый класс Object конкретных тегов SVG-документа
+     * Реализует паттерн "Шаблонный метод" для вывода содержимого тега, метод RenderObject
+     * наследника вызывается статически (CRTP), объекты хранятся по значению без виртуальных вызовов
      */
+    template <typename Owner>
     class Object {
     public:
-        void Render(const RenderContext& context) const;
+        void Render(const RenderContext& context) const {
+            context.RenderIndent();
 
-        virtual ~Object() = default;
+            // Делегируем вывод тега своим подклассам
+            static_cast<const Owner&>(*this).RenderObject(context);
 
-    private:
-        virtual void RenderObject(const RenderContext& context) const = 0;
+            // Без сброса буфера потока после каждого объекта
+            context.out << '\n';
+        }
+
+    protected:
+        ~Object() = default;
     };
 
     /*
      * Класс Circle моделирует элемент <circle> для отображения круга
      * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/circle
      */
-    class Circle final : public Object, public PathProps<Circle> {
+    class Circle final : public Object<Circle>, public PathProps<Circle> {
     public:
         Circle& SetCenter(Point center);
         Circle& SetRadius(double radius);
 
     private:
-        void RenderObject(const RenderContext& context) const override;
+        friend class Object<Circle>;
+
+        void RenderObject(const RenderContext& context) const;
 
         Point center_;
         double radius_ = 1.0;
@@ -196,14 +223,15 @@ namespace svg {
      * Класс Polyline моделирует элемент <polyline> для отображения ломаных линий
      * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/polyline
      */
-    class Polyline final : public Object, public PathProps<Polyline> {
+    class Polyline final : public Object<Polyline>, public PathProps<Polyline> {
     public:
         // Добавляет очередную вершину к ломаной линии
         Polyline& AddPoint(Point point);
 
     private:
+        friend class Object<Polyline>;
 
-        void RenderObject(const RenderContext& context) const override;
+        void RenderObject(const RenderContext& context) const;
 
         std::vector<Point> points_;
     };
@@ -212,7 +240,7 @@ namespace svg {
      * Класс Text моделирует элемент <text> для отображения текста
      * https://developer.mozilla.org/en-US/docs/Web/SVG/Element/text
      */
-    class Text final : public Object, public PathProps<Text> {
+    class Text final : public Object<Text>, public PathProps<Text> {
     public:
         // Задаёт координаты опорной точки (атрибуты x и y)
         Text& SetPosition(Point pos);
@@ -233,9 +261,11 @@ namespace svg {
         Text& SetData(std::string data);
 
     private:
+        friend class Object<Text>;
+
         std::string RenderText(const std::string& text) const;
 
-        void RenderObject(const RenderContext& context) const override;
+        void RenderObject(const RenderContext& context) const;
 
         Point pos_;
         Point offset_;
@@ -245,6 +275,9 @@ namespace svg {
         std::string data_;
     };
 
+    // Любой из тегов SVG-документа, хранится по значению
+    using AnyObject = std::variant<Circle, Polyline, Text>;
+
     /*
      * Интерфейс, представляющий контейнер SVG объектов.
      */
@@ -252,11 +285,11 @@ namespace svg {
     public:
         template <typename ObjectType>
         void Add(ObjectType object) {
-            AddPtr(std::make_unique<ObjectType>(std::move(object)));
+            AddObject(AnyObject{ std::move(object) });
         }
 
-        // Добавляет в svg-документ объект-наследник svg::Object
-        virtual void AddPtr(std::unique_ptr<Object>&& obj) = 0;
+        // Добавляет в svg-документ объект
+        virtual void AddObject(AnyObject&& object) = 0;
 
     protected:
         // Интерфейс не предполагает полиморфное удаление
@@ -279,14 +312,44 @@ namespace svg {
 
     class Document : public ObjectContainer {
     public:
-        // Добавляет в svg-документ объект-наследник svg::Object
-        void AddPtr(std::unique_ptr<Object>&& obj) override;
+        // Добавляет в svg-документ объект
+        void AddObject(AnyObject&& object) override;
 
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
 
     private:
-        std::vector<std::unique_ptr<Object>> objects_;
+        // Объекты хранятся подряд в одном массиве, вывод выбирается по типу через std::visit
+        std::vector<AnyObject> objects_;
+    };
+
+    /*
+     * Поток объектов: объекты не хранятся, а выводятся в поток сразу при добавлении
+     * в том же виде, что и внутри документа, но без заголовка и закрывающего тега
+     */
+    class ObjectStream : public ObjectContainer {
+    public:
+        explicit ObjectStream(std::ostream& out)
+            : out_(out) {
+        }
+
+        // Выводит объект в поток
+        void AddObject(AnyObject&& object) override;
+
+    protected:
+        std::ostream& out_;
+    };
+
+    /*
+     * Потоковый документ: заголовок выводится в конструкторе, объекты - сразу при добавлении,
+     * закрывающий тег - методом Finish. Вывод совпадает с выводом Document::Render для тех же объектов
+     */
+    class StreamDocument : public ObjectStream {
+    public:
+        explicit StreamDocument(std::ostream& out);
+
+        // Завершает документ, после этого объекты добавлять нельзя
+        void Finish();
     };
 
 }  // namespace svg
\ No newline at end of file
@@ -0,0 +1,187 @@
+/*
+ * Проверка поэтапного обновления TransportRoute (AddBus и UpdateDistance): после каждого добавления
+ * маршрута или изменения расстояния ответы обновленного TransportRoute сравниваются с ответами
+ * TransportRoute, построенного по тому же каталогу заново, во всех режимах поиска.
+ * Сборка и запуск из каталога transport-catalogue:
+ *     g++ -std=c++20 -O2 tests/transport_router_update.cpp $(ls *.cpp | grep -v main.cpp) -o router_update -pthread
+ *     ./router_update
+ * Выводит расхождения и их количество, при расхождениях завершается с кодом 1
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../transport_catalogue.h"
+#include "../transport_router.h"
+
+using namespace std::literals;
+
+namespace {
+
+	constexpr size_t STOPS_COUNT = 30;
+	constexpr size_t BUSES_COUNT = 16;
+	constexpr size_t DISTANCE_UPDATES_COUNT = 12;
+
+	// Маршрут тестовой сети: название, остановки (для некольцевого - только прямое направление)
+	struct BusDescription {
+		std::string name;
+		std::vector<size_t> stops;
+		bool is_roundtrip = false;
+	};
+
+	struct Network {
+		std::vector<std::string> stop_names;
+		std::vector<BusDescription> buses;
+	};
+
+	Network GenerateNetwork(std::mt19937& generator) {
+		Network network;
+		for (size_t i = 0; i < STOPS_COUNT; ++i) {
+			network.stop_names.push_back("Stop "s + std::to_string(i));
+		}
+		std::vector<size_t> stops(STOPS_COUNT);
+		for (size_t i = 0; i < STOPS_COUNT; ++i) {
+			stops[i] = i;
+		}
+		for (size_t i = 0; i < BUSES_COUNT; ++i) {
+			std::shuffle(stops.begin(), stops.end(), generator);
+			const size_t stops_count = std::uniform_int_distribution<size_t>(2, 7)(generator);
+			BusDescription bus{ "Bus "s + std::to_string(i), { stops.begin(), stops.begin() + stops_count },
+				generator() % 2 == 0 };
+			if (bus.is_roundtrip) {
+				bus.stops.push_back(bus.stops.front());
+			}
+			network.buses.push_back(std::move(bus));
+		}
+		return network;
+	}
+
+	// Добавляет в каталог все остановки сети и расстояния между соседними остановками маршрутов
+	void AddStops(const Network& network, std::mt19937& generator, transport_catalogue::TransportCatalogue& catalogue) {
+		std::uniform_real_distribution<double> coordinate(0.0, 0.05);
+		for (const auto& name : network.stop_names) {
+			catalogue.AddStop({ name, { 55.6 + coordinate(generator), 37.5 + coordinate(generator) } });
+		}
+		std::uniform_int_distribution<int> distance(500, 5000);
+		for (const auto& bus : network.buses) {
+			for (size_t i = 1; i < bus.stops.size(); ++i) {
+				catalogue.AddDistanceBetweenStops(network.stop_names[bus.stops[i - 1]],
+					network.stop_names[bus.stops[i]], distance(generator));
+			}
+		}
+		catalogue.SetBusWaitTime(4);
+		catalogue.SetBusVelocity(30.0);
+	}
+
+	const domain::Bus& AddBus(const Network& network, const BusDescription& bus,
+		transport_catalogue::TransportCatalogue& catalogue)
+	{
+		std::vector<const domain::Stop*> bus_stops;
+		for (const size_t stop : bus.stops) {
+			bus_stops.push_back(catalogue.GetStop(network.stop_names[stop]));
+		}
+		if (!bus.is_roundtrip) {
+			for (auto iter = bus.stops.crbegin() + 1; iter != bus.stops.crend(); ++iter) {
+				bus_stops.push_back(catalogue.GetStop(network.stop_names[*iter]));
+			}
+		}
+		return catalogue.AddBus({ bus.name, bus_stops, bus.is_roundtrip });
+	}
+
+	// Сравнивает время маршрутов между всеми парами остановок. Маршруты с равным временем могут
+	// различаться, а время - в последних знаках из-за разного порядка сложения весов
+	size_t CompareRoutes(const Network& network, const transport_catalogue::TransportCatalogue& catalogue,
+		const router::TransportRoute& updated, const std::string& step)
+	{
+		const router::TransportRoute expected(catalogue, updated.GetSettings());
+		size_t mismatches = 0;
+		for (const auto& from : network.stop_names) {
+			for (const auto& to : network.stop_names) {
+				const auto updated_info = updated.GetRouteInfo(from, to);
+				const auto expected_info = expected.GetRouteInfo(from, to);
+				if (updated_info.has_value() == expected_info.has_value()
+					&& (!updated_info || std::abs(updated_info->total_time - expected_info->total_time)
+						<= 1e-9 * std::max(1.0, expected_info->total_time))) {
+					continue;
+				}
+				++mismatches;
+				std::cerr << step << ": "s << from << " -> "s << to << ": "s
+					<< (updated_info ? std::to_string(updated_info->total_time) : "not found"s) << " instead of "s
+					<< (expected_info ? std::to_string(expected_info->total_time) : "not found"s) << std::endl;
+			}
+		}
+		return mismatches;
+	}
+
+	// Строит TransportRoute по первым initial_buses маршрутам сети, затем по одному добавляет остальные
+	// и меняет расстояния между соседними остановками маршрутов, сверяя ответы после каждого шага
+	size_t CheckUpdates(const Network& network, size_t initial_buses, router::RoutingSettings settings,
+		std::mt19937 generator)
+	{
+		transport_catalogue::TransportCatalogue catalogue;
+		AddStops(network, generator, catalogue);
+		for (size_t i = 0; i < initial_buses; ++i) {
+			AddBus(network, network.buses[i], catalogue);
+		}
+		catalogue.Finalize();
+
+		router::TransportRoute route(catalogue, settings);
+		size_t mismatches = CompareRoutes(network, catalogue, route, "build"s);
+
+		for (size_t i = initial_buses; i < network.buses.size(); ++i) {
+			route.AddBus(catalogue, AddBus(network, network.buses[i], catalogue));
+			mismatches += CompareRoutes(network, catalogue, route, "add "s + network.buses[i].name);
+		}
+
+		// Расстояния и уменьшаются, и увеличиваются, в том числе в обратном направлении перегона
+		std::uniform_int_distribution<int> distance(100, 8000);
+		for (size_t i = 0; i < DISTANCE_UPDATES_COUNT; ++i) {
+			const auto& bus = network.buses[generator() % network.buses.size()];
+			const size_t index = 1 + generator() % (bus.stops.size() - 1);
+			std::string_view first = network.stop_names[bus.stops[index - 1]];
+			std::string_view second = network.stop_names[bus.stops[index]];
+			if (generator() % 2 == 0) {
+				std::swap(first, second);
+			}
+			catalogue.AddDistanceBetweenStops(first, second, distance(generator));
+			route.UpdateDistance(catalogue, first, second);
+			mismatches += CompareRoutes(network, catalogue, route,
+				"distance "s + std::string(first) + " - "s + std::string(second));
+		}
+		return mismatches;
+	}
+
+} // namespace
+
+int main() {
+	const std::pair<router::RouterMode, std::string> modes[] = {
+		{ router::RouterMode::ALL_PAIRS, "all_pairs"s },
+		{ router::RouterMode::A_STAR, "a_star"s },
+		{ router::RouterMode::ALT, "alt"s },
+		{ router::RouterMode::RAPTOR, "raptor"s }
+	};
+
+	size_t mismatches = 0;
+	for (const unsigned seed : { 1u, 2u, 3u }) {
+		std::mt19937 generator(seed);
+		const Network network = GenerateNetwork(generator);
+		for (const auto& [mode, mode_name] : modes) {
+			router::RoutingSettings settings;
+			settings.mode = mode;
+			settings.landmarks_count = 4;
+			// Граф строится по половине маршрутов и по пустой сети, затем дополняется
+			for (const size_t initial_buses : { BUSES_COUNT / 2, size_t{ 0 } }) {
+				const size_t count = CheckUpdates(network, initial_buses, settings, generator);
+				std::cout << mode_name << ", seed "s << seed << ", initial buses "s << initial_buses
+					<< ": "s << count << " mismatches"s << std::endl;
+				mismatches += count;
+			}
+		}
+	}
+	std::cout << "total mismatches: "s << mismatches << std::endl;
+	return (mismatches == 0) ? 0 : 1;
+}
@@ -2,7 +2,7 @@
 
 #include <algorithm>
 #include <optional>
-#include <set>
+#include <stdexcept>
 #include <unordered_set>
 
 namespace transport_catalogue {
@@ -10,8 +10,8 @@ namespace transport_catalogue {
 	using namespace std;
 
 	// Возвращает количество уникальных остановок в векторе
-	int UnigueStopsCount(vector<const domain::Stop*> bus_stops) {
-		auto arr = bus_stops;
+	int UnigueStopsCount(span<const domain::Stop* const> bus_stops) {
+		vector<const domain::Stop*> arr(bus_stops.begin(), bus_stops.end());
 
 		std::sort(arr.begin(), arr.end(), [](const domain::Stop* lhs, const domain::Stop* rhs) {
 			return lhs->name < rhs->name;
@@ -21,20 +21,36 @@ namespace transport_catalogue {
 		return static_cast<int>(arr.size());
 	}
 
-	// Возвращает "кратчайшую" длину маршрута 
-	double CalculateGeoDistance(vector<const domain::Stop*> bus_stops) {
-		double geo_distance = 0.0;
-		for (size_t i = 1; i < bus_stops.size(); ++i)
-		{
-			geo_distance += geo::ComputeDistance(bus_stops[i - 1]->coordinates,
-				bus_stops[i]->coordinates);
-		};
-		return geo_distance;
+	// Возвращает "кратчайшие" длины маршрутов buses. Синусы и косинусы широт берутся из domain::Stop,
+	// поэтому для каждого перегона вычисляется только косинус разности долгот
+	vector<double> CalculateGeoDistances(span<const domain::Bus* const> buses) {
+		vector<double> result;
+		result.reserve(buses.size());
+		for (const auto bus : buses) {
+			double geo_distance = 0.0;
+			for (size_t i = 1; i < bus->bus_stops.size(); ++i) {
+				const domain::Stop* from = bus->bus_stops[i - 1];
+				const domain::Stop* to = bus->bus_stops[i];
+				geo_distance += geo::ComputeDistance(from->coordinates, from->latitude_trig,
+					to->coordinates, to->latitude_trig);
+			}
+			result.push_back(geo_distance);
+		}
+		return result;
 	}
 
 	const domain::Stop& TransportCatalogue::AddStop(domain::Stop&& stop) {
-		stops_.push_back(stop);
+		stop.name_handle = names_.Intern(stop.name);
+		stop.name = names_.GetString(stop.name_handle);
+		stop.id = static_cast<uint32_t>(stops_.size());
+		stop.latitude_trig = geo::ComputeLatitudeTrig(stop.coordinates);
+		stop.revision = ++revision_;
+		stops_.push_back(std::move(stop));
 		stop_name_to_stops_and_stop_buses_[stops_.back().name] = { &stops_.back(), {} };
+		if (is_finalized_) {
+			const domain::Stop* const stops[] = { &stops_.back() };
+			stops_index_.Add(stops);
+		}
 		return stops_.back();
 	}
 
@@ -45,11 +61,32 @@ namespace transport_catalogue {
 	}
 
 	const domain::Bus& TransportCatalogue::AddBus(domain::Bus&& bus) {
-		buses_.push_back(bus);
+		bus.name_handle = names_.Intern(bus.name);
+		bus.name = names_.GetString(bus.name_handle);
+		bus.id = static_cast<uint32_t>(buses_.size());
+
+		// Остановки маршрута копируются в arena_, чтобы не зависеть от памяти вызывающего
+		const auto bus_stops = AllocateArray<const domain::Stop*>(bus.bus_stops.size());
+		std::copy(bus.bus_stops.begin(), bus.bus_stops.end(), bus_stops.begin());
+		bus.bus_stops = bus_stops;
+		bus.route_distances = AllocateArray<int>(bus_stops.size());
+		bus.revision = ++revision_;
+
+		buses_.push_back(std::move(bus));
 		bus_name_to_buses_[buses_.back().name] = &buses_.back();
 
+		const string_view bus_name = buses_.back().name;
 		for (const auto& bus_stop : buses_.back().bus_stops) {
-			stop_name_to_stops_and_stop_buses_[bus_stop->name].second.insert(buses_.back().name);
+			auto& stop_buses = stop_name_to_stops_and_stop_buses_[bus_stop->name].second;
+			// Повторные посещения остановки этим же маршрутом не добавляются
+			const auto iter = std::lower_bound(stop_buses.begin(), stop_buses.end(), bus_name);
+			if (iter == stop_buses.end() || *iter != bus_name) {
+				stop_buses.insert(iter, bus_name);
+			}
+		}
+		FillRouteDistances(buses_.back());
+		if (is_finalized_) {
+			IndexBus(buses_.back());
 		}
 
 		return buses_.back();
@@ -63,54 +100,60 @@ namespace transport_catalogue {
 
 	void TransportCatalogue::AddDistanceBetweenStops(string_view first_stop,
 		string_view second_stop, int distance) {
-		stops_to_stop_to_distance_[detail::StopToStop{ GetStop(first_stop),
-			GetStop(second_stop) }] = distance;
-	}
-
-	int TransportCatalogue::GetDistanceBetweenStops(string_view first_stop,
-		string_view second_stop) const {
-		auto iter = stops_to_stop_to_distance_.find(detail::StopToStop{ GetStop(first_stop),
-			GetStop(second_stop) });
-		if (iter != stops_to_stop_to_distance_.end()) {
+		const domain::Stop* first = GetStop(first_stop);
+		const domain::Stop* second = GetStop(second_stop);
+		if (first && second) {
+			stops_to_stop_to_distance_.Set(first->id, second->id, distance);
+			++revision_;
 
-			return iter->second;
+			// Перегон first - second (в любом направлении) есть только у маршрутов через first
+			for (const auto bus_name : GetBusesByStop(first_stop)) {
+				domain::Bus& bus = *bus_name_to_buses_.at(bus_name);
+				FillRouteDistances(bus);
+				bus.revision = revision_;
+			}
 		}
-		iter = stops_to_stop_to_distance_.find(detail::StopToStop{ GetStop(second_stop),
-			GetStop(first_stop) });
-		if (iter != stops_to_stop_to_distance_.end()) {
+	}
 
-			return iter->second;
+	void TransportCatalogue::FillRouteDistances(domain::Bus& bus) const {
+		int distance = 0;
+		for (size_t i = 0; i < bus.bus_stops.size(); ++i) {
+			if (i > 0) {
+				distance += GetDistanceBetweenStops(bus.bus_stops[i - 1], bus.bus_stops[i]);
+			}
+			bus.route_distances[i] = distance;
 		}
-		return 0;
 	}
 
-	int TransportCatalogue::CalculateRouteLength(vector<const domain::Stop*> bus_stops) const {
-		int route_length = 0;
-
-		for (size_t i = 1; i < bus_stops.size(); ++i)
-		{
-			route_length += GetDistanceBetweenStops(bus_stops[i - 1]->name,
-				bus_stops[i]->name);
-		};
+	int TransportCatalogue::GetDistanceBetweenStops(string_view first_stop,
+		string_view second_stop) const {
+		return GetDistanceBetweenStops(GetStop(first_stop), GetStop(second_stop));
+	}
 
-		return route_length;
+	int TransportCatalogue::GetDistanceBetweenStops(const domain::Stop* first_stop,
+		const domain::Stop* second_stop) const {
+		if (!first_stop || !second_stop) {
+			return 0;
+		}
+		return stops_to_stop_to_distance_.Get(first_stop->id, second_stop->id);
 	}
 
 	const optional<detail::RouteInformation> TransportCatalogue::GetRouteInformation(const string_view bus_name) const {
-		if (GetBus(bus_name)) {
-			const auto& found_bus_stops = GetBus(bus_name)->bus_stops;
-			int route_length = CalculateRouteLength(found_bus_stops);
+		CheckFinalized();
+		if (const auto bus = GetBus(bus_name)) {
+			const int route_length = (bus->bus_stops.empty()) ? 0 : bus->route_distances.back();
+			const BusStatistics& statistics = bus_statistics_[bus->id];
 
-			return detail::RouteInformation{ static_cast<int>(found_bus_stops.size()),
-				UnigueStopsCount(found_bus_stops), route_length,
-				 route_length / CalculateGeoDistance(found_bus_stops) };
+			return detail::RouteInformation{ static_cast<int>(bus->bus_stops.size()),
+				statistics.unique_stops_count, route_length,
+				 route_length / statistics.geo_length };
 		}
 		else {
 			return {};
 		}
 	}
 
-	const optional<set<string_view>> TransportCatalogue::GetStopInformation(const string_view stop_name) const {
+	const optional<span<const string_view>> TransportCatalogue::GetStopInformation(const string_view stop_name) const {
 
 		if (GetStop(stop_name)) {
 			return GetBusesByStop(stop_name);
@@ -120,30 +163,111 @@ namespace transport_catalogue {
 		}
 	}
 
-	const vector<const domain::Bus*> TransportCatalogue::GetUniqueBuses() const {
-		const auto& buses = bus_name_to_buses_;
-
-		vector<const domain::Bus*> result;
-		result.reserve(buses.size());
+	void TransportCatalogue::Finalize() {
+		if (is_finalized_) {
+			return;
+		}
 
-		for (const auto& bus : buses) {
-			result.push_back(bus.second);
+		sorted_buses_.clear();
+		sorted_buses_.reserve(buses_.size());
+		for (const auto& bus : buses_) {
+			sorted_buses_.push_back(&bus);
+		}
+		const vector<double> geo_distances = CalculateGeoDistances(sorted_buses_);
+		bus_statistics_.clear();
+		bus_statistics_.reserve(buses_.size());
+		for (const auto& bus : buses_) {
+			bus_statistics_.push_back({ UnigueStopsCount(bus.bus_stops), geo_distances[bus.id] });
 		}
-		std::sort(result.begin(), result.end(), [](const domain::Bus* lhs, const domain::Bus* rhs) {
+		std::sort(sorted_buses_.begin(), sorted_buses_.end(), [](const domain::Bus* lhs, const domain::Bus* rhs) {
 			return lhs->name < rhs->name;
 			});
-		return result;
-	}
 
-	const vector<const domain::Stop*> TransportCatalogue::GetUniqueStops() const {
-		std::vector<const domain::Stop*> result;
-		for (const auto& bus : GetUniqueBuses()) {
-			result.insert(result.end(), bus->bus_stops.begin(), bus->bus_stops.end());
+		sorted_stops_.clear();
+		for (auto& [stop_name, stop_and_buses] : stop_name_to_stops_and_stop_buses_) {
+			stop_and_buses.second.shrink_to_fit();
+			if (!stop_and_buses.second.empty()) {
+				sorted_stops_.push_back(stop_and_buses.first);
+			}
 		}
-		std::sort(result.begin(), result.end(), [](const domain::Stop* lhs, const domain::Stop* rhs) {
+		std::sort(sorted_stops_.begin(), sorted_stops_.end(), [](const domain::Stop* lhs, const domain::Stop* rhs) {
 			return lhs->name < rhs->name;
 			});
-		result.erase(std::unique(result.begin(), result.end()), result.end());
-		return result;
+
+		vector<const domain::Stop*> stops;
+		stops.reserve(stops_.size());
+		for (const auto& stop : stops_) {
+			stops.push_back(&stop);
+		}
+		stops_index_ = detail::StopsSpatialIndex(stops);
+		served_stops_index_ = detail::StopsSpatialIndex(sorted_stops_);
+		buses_index_ = detail::BusSegmentsSpatialIndex(sorted_buses_);
+
+		is_finalized_ = true;
+		++revision_;
+	}
+
+	void TransportCatalogue::IndexBus(const domain::Bus& bus) {
+		const auto bus_iter = std::lower_bound(sorted_buses_.begin(), sorted_buses_.end(), bus.name,
+			[](const domain::Bus* lhs, string_view name) { return lhs->name < name; });
+		sorted_buses_.insert(bus_iter, &bus);
+		bus_statistics_.resize(buses_.size());
+		const domain::Bus* const buses[] = { &bus };
+		bus_statistics_[bus.id] = { UnigueStopsCount(bus.bus_stops), CalculateGeoDistances(buses).front() };
+
+		vector<const domain::Stop*> new_stops;
+		for (const auto stop : bus.bus_stops) {
+			const auto stop_iter = std::lower_bound(sorted_stops_.begin(), sorted_stops_.end(), stop->name,
+				[](const domain::Stop* lhs, string_view name) { return lhs->name < name; });
+			if (stop_iter == sorted_stops_.end() || *stop_iter != stop) {
+				sorted_stops_.insert(stop_iter, stop);
+				new_stops.push_back(stop);
+			}
+		}
+		served_stops_index_.Add(new_stops);
+		buses_index_.Add(buses);
+	}
+
+	void TransportCatalogue::CheckFinalized() const {
+		if (!is_finalized_) {
+			throw std::logic_error("TransportCatalogue is not finalized"s);
+		}
+	}
+
+	vector<detail::StopDistance> TransportCatalogue::GetNearestStops(geo::Coordinates center, size_t count) const {
+		CheckFinalized();
+		return stops_index_.FindNearest(center, count);
+	}
+
+	vector<detail::StopDistance> TransportCatalogue::GetNearestServedStops(geo::Coordinates center, size_t count) const {
+		CheckFinalized();
+		return served_stops_index_.FindNearest(center, count);
+	}
+
+	vector<detail::StopDistance> TransportCatalogue::GetStopsWithinRadius(geo::Coordinates center, double radius) const {
+		CheckFinalized();
+		return stops_index_.FindWithinRadius(center, radius);
+	}
+
+	vector<const domain::Stop*> TransportCatalogue::GetStopsInBox(geo::Coordinates min_corner,
+		geo::Coordinates max_corner) const {
+		CheckFinalized();
+		return stops_index_.FindInBox(min_corner, max_corner);
+	}
+
+	vector<const domain::Bus*> TransportCatalogue::GetBusesInBox(geo::Coordinates min_corner,
+		geo::Coordinates max_corner) const {
+		CheckFinalized();
+		return buses_index_.FindInBox(min_corner, max_corner);
+	}
+
+	span<const domain::Bus* const> TransportCatalogue::GetUniqueBuses() const {
+		CheckFinalized();
+		return sorted_buses_;
+	}
+
+	span<const domain::Stop* const> TransportCatalogue::GetUniqueStops() const {
+		CheckFinalized();
+		return sorted_stops_;
 	}
 }
\ No newline at end of file
@@ -1,14 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
-#include <set>
+#include <memory_resource>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "distance_table.h"
 #include "domain.h"
+#include "spatial_index.h"
+#include "string_pool.h"
 #include "geo.h"
 
 namespace transport_catalogue {
@@ -21,22 +26,6 @@ namespace transport_catalogue {
 			int route_length = 0;
 			double curvature = 0.0;
 		};
-
-		// Структура для доступа к расстоянию между остановками в словаре TransportCatalogue
-		struct StopToStop {
-			const domain::Stop* first_stop;
-			const domain::Stop* second_stop;
-			bool operator==(const StopToStop&) const = default;
-		};
-
-		struct StopToStopHash {
-			std::size_t operator()(const StopToStop& stops) const {
-				std::size_t hash_1 = reinterpret_cast<size_t>(stops.first_stop);
-				std::size_t hash_2 = reinterpret_cast<size_t>(stops.second_stop);
-				return hash_1 ^ (hash_2 << 1);
-			}
-		};
-
 	}
 
 	class TransportCatalogue {
@@ -55,25 +44,57 @@ namespace transport_catalogue {
 		// Возвращает "действительное" расстояние между остановками
 		int GetDistanceBetweenStops(std::string_view first_stop,
 			std::string_view second_stop) const;
+		int GetDistanceBetweenStops(const domain::Stop* first_stop, const domain::Stop* second_stop) const;
 
-		// Возвращает длину маршрута
-		int CalculateRouteLength(std::vector<const domain::Stop*> bus_stops) const;
-
-		// Возвращает "набор" названий автобусных маршрутов проходящих через остановку 
-		const std::set<std::string_view>& GetBusesByStop(std::string_view stop_name) const
+		// Возвращает отсортированные названия автобусных маршрутов проходящих через остановку
+		// (действительны до следующего добавления маршрута)
+		std::span<const std::string_view> GetBusesByStop(std::string_view stop_name) const
 		{ return stop_name_to_stops_and_stop_buses_.at(stop_name).second; };
 
-		// Возвращает вектор уникальных указателей всех автобусных маршрутов отсортированный по названию
-		const std::vector<const domain::Bus*> GetUniqueBuses() const;
+		// Строит отсортированные индексы маршрутов и остановок и вычисляет характеристики маршрутов,
+		// не зависящие от расстояний. Вызывается после загрузки базы, маршруты и расстояния,
+		// добавленные после Finalize, учитываются в индексах сразу при добавлении
+		void Finalize();
+
+		bool IsFinalized() const { return is_finalized_; }
+
+		// Номер изменения каталога: увеличивается при каждом добавлении остановки, маршрута
+		// или расстояния и при Finalize. По нему проверяется, что данные, сохраненные по каталогу, не устарели.
+		// Изменившиеся остановки и маршруты получают текущий номер в domain::Stop::revision и domain::Bus::revision
+		uint64_t GetRevision() const { return revision_; }
 
-		// Возвращает вектор уникальных указателей всех остановок отсортированный по названию
-		const std::vector<const domain::Stop*> GetUniqueStops() const;
+		// Возвращает указатели всех автобусных маршрутов отсортированные по названию
+		// (действительны до следующего добавления маршрута, требует Finalize)
+		std::span<const domain::Bus* const> GetUniqueBuses() const;
 
-		// Возвращает информацию о маршруте (запрос Bus)
+		// Возвращает указатели всех остановок, через которые проходят маршруты, отсортированные по названию
+		// (действительны до следующего добавления маршрута, требует Finalize)
+		std::span<const domain::Stop* const> GetUniqueStops() const;
+
+		// Возвращает информацию о маршруте (запрос Bus, требует Finalize)
 		const std::optional<detail::RouteInformation> GetRouteInformation(const std::string_view bus_name) const;
 
+		// Возвращают остановки по положению (запросы NearestStops, StopsInRadius, StopsInBox,
+		// требуют Finalize): count ближайших к точке center, находящиеся не дальше radius метров от нее
+		// и лежащие в прямоугольнике координат [min_corner, max_corner]
+		std::vector<detail::StopDistance> GetNearestStops(geo::Coordinates center, size_t count) const;
+
+		// Возвращает count ближайших к точке center остановок, через которые проходят маршруты
+		// (начальные и конечные остановки маршрута между точками, требует Finalize)
+		std::vector<detail::StopDistance> GetNearestServedStops(geo::Coordinates center, size_t count) const;
+		std::vector<detail::StopDistance> GetStopsWithinRadius(geo::Coordinates center, double radius) const;
+		std::vector<const domain::Stop*> GetStopsInBox(geo::Coordinates min_corner, geo::Coordinates max_corner) const;
+
+		// Возвращает маршруты, перегоны которых пересекают прямоугольник координат [min_corner, max_corner],
+		// отсортированные по названию (требует Finalize)
+		std::vector<const domain::Bus*> GetBusesInBox(geo::Coordinates min_corner, geo::Coordinates max_corner) const;
+
 		// Возвращает маршруты, проходящие через остановку (запрос Stop)
-		const std::optional<std::set<std::string_view>> GetStopInformation(const std::string_view stop_name) const;
+		const std::optional<std::span<const std::string_view>> GetStopInformation(const std::string_view stop_name) const;
+
+		// Пул названий остановок и маршрутов: по дескрипторам name_handle из domain::Stop и domain::Bus
+		// можно получить названия
+		const detail::StringPool& GetNames() const { return names_; }
 
 		int GetBusWaitTime() const { return bus_wait_time_; } 
 		double GetBusVelocity() const { return bus_velocity_; }
@@ -83,21 +104,65 @@ namespace transport_catalogue {
 
 	private:
 		
-		std::deque<domain::Stop> stops_;
-		std::deque<domain::Bus> buses_;
+		// Монотонный буфер, из блоков которого выделяется память под остановки, маршруты,
+		// последовательности остановок маршрутов и их расстояния. Память не освобождается
+		// до разрушения TransportCatalogue, адреса объектов не меняются
+		std::pmr::monotonic_buffer_resource arena_;
+
+		// Названия всех остановок и маршрутов
+		detail::StringPool names_;
+
+		std::pmr::deque<domain::Stop> stops_{ &arena_ };
+		std::pmr::deque<domain::Bus> buses_{ &arena_ };
 
 		int bus_wait_time_ = 0;
 		double bus_velocity_ = 0.0;
 
-		// Словарь хранящий указатели на остановки и "набор" названий автобусов проходящих через эту остановку с доступом по имени остановки
+		// Словарь хранящий указатели на остановки и отсортированные без повторов названия автобусов
+		// проходящих через эту остановку с доступом по имени остановки
 		std::unordered_map<std::string_view, std::pair<const domain::Stop*,
-			std::set<std::string_view>>> stop_name_to_stops_and_stop_buses_;
+			std::vector<std::string_view>>> stop_name_to_stops_and_stop_buses_;
 
 		//  Словарь хранящий указатели на автобусные маршруты с доступом по его имени
-		std::unordered_map<std::string_view, const domain::Bus*> bus_name_to_buses_;
+		std::unordered_map<std::string_view, domain::Bus*> bus_name_to_buses_;
+
+		//  Таблица хранящая "действительное" расстояния между остановками с доступом по их идентификаторам
+		detail::DistanceTable stops_to_stop_to_distance_;
+
+		// Характеристики маршрута, не зависящие от расстояний между остановками
+		struct BusStatistics {
+			int unique_stops_count = 0;
+			double geo_length = 0.0;
+		};
 
-		//  Словарь хранящий "действительное" расстояния между остановками с доступом по структуре StopToStop
-		std::unordered_map<detail::StopToStop, int, detail::StopToStopHash> stops_to_stop_to_distance_;
+		bool is_finalized_ = false;
+		uint64_t revision_ = 0;
+
+		// Индексы, которые строит Finalize: маршруты и остановки маршрутов, отсортированные по названию,
+		// и характеристики маршрутов по domain::Bus::id, пространственные индексы всех остановок,
+		// остановок маршрутов и перегонов
+		std::vector<const domain::Bus*> sorted_buses_;
+		std::vector<const domain::Stop*> sorted_stops_;
+		std::vector<BusStatistics> bus_statistics_;
+		detail::StopsSpatialIndex stops_index_;
+		detail::StopsSpatialIndex served_stops_index_;
+		detail::BusSegmentsSpatialIndex buses_index_;
+
+		// Выделяет в arena_ массив из size элементов
+		template <typename T>
+		std::span<T> AllocateArray(size_t size) {
+			std::pmr::polymorphic_allocator<T> allocator(&arena_);
+			return { allocator.allocate(size), size };
+		}
+
+		// Заполняет префиксные суммы расстояний route_distances маршрута bus
+		void FillRouteDistances(domain::Bus& bus) const;
+
+		// Добавляет маршрут bus и его остановки в индексы Finalize
+		void IndexBus(const domain::Bus& bus);
+
+		// Выбрасывает std::logic_error, если Finalize еще не вызывался
+		void CheckFinalized() const;
 
 	};
 }
\ No newline at end of file
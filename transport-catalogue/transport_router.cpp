@@ -1,5 +1,9 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 namespace router {
 
 bool operator<(const GraphWeight& lhs, const GraphWeight& rhs) {
@@ -18,6 +22,10 @@ GraphWeight operator+(const GraphWeight& lhs, const GraphWeight& rhs) {
 }
 
 const std::optional<RouterInformation> TransportRoute::GetRouteInfo(std::string_view from, std::string_view to) const {
+	if (raptor_router_) {
+		return raptor_router_->GetRouteInfo(from, to);
+	}
+
 	RouterInformation result;
 
 	if (!IsCorrectStop(from) || !IsCorrectStop(to)) {
@@ -25,16 +33,21 @@ const std::optional<RouterInformation> TransportRoute::GetRouteInfo(std::string_
 	}
 
 	// Маршрут всегда начинается в дублере остановки from и заканивается в дублере остановки to
-	const auto info = router_.BuildRoute(
-		GetWaitVertexIndex(GetVertexIndex(from)), GetWaitVertexIndex(GetVertexIndex(to))
-	);
+	const auto from_vertex = GetWaitVertexIndex(GetVertexIndex(from));
+	const auto to_vertex = GetWaitVertexIndex(GetVertexIndex(to));
+
+	const auto info = (router_) ? router_->BuildRoute(from_vertex, to_vertex)
+		: astar_router_.BuildRoute(from_vertex, to_vertex, [this, to_vertex](graph::VertexId vertex) {
+			return EstimateRemainingTime(vertex, to_vertex);
+			});
 
 	if (info.has_value()) {
 		const auto info_value = info.value();
-		result.total_time = info_value.weight.time;
 		for (const auto edge_index : info_value.edges) {
 			result.items.push_back(CreateRouteItem(edge_index));
 		}
+		// В режиме all_pairs время маршрута - вес из таблицы маршрутов, в режиме A* - сумма времен элементов
+		result.total_time = (router_) ? info_value.weight.time : ComputeTotalTime(result.items);
 		return result;
 	}
 	else {
@@ -42,45 +55,307 @@ const std::optional<RouterInformation> TransportRoute::GetRouteInfo(std::string_
 	}
 }
 
+const std::optional<RouterInformation> TransportRoute::GetRouteInfo(
+	std::span<const transport_catalogue::detail::StopDistance> from_stops,
+	std::span<const transport_catalogue::detail::StopDistance> to_stops) const
+{
+	const auto sources = GetRouteEndpoints(from_stops);
+	const auto targets = GetRouteEndpoints(to_stops);
+	if (raptor_router_) {
+		return raptor_router_->GetRouteInfo(sources, targets);
+	}
+	if (sources.empty() || targets.empty()) {
+		return std::nullopt;
+	}
+
+	RouterInformation result;
+	const RouteEndpoint* best_source = nullptr;
+	const RouteEndpoint* best_target = nullptr;
+	std::vector<graph::EdgeId> edges;
+
+	if (router_) {
+		// Таблица отвечает на запрос для пары остановок за O(1), поэтому перебираем все пары
+		for (const auto& source : sources) {
+			for (const auto& target : targets) {
+				const auto info = router_->BuildRoute(GetWaitVertexIndex(GetVertexIndex(source.stop_name)),
+					GetWaitVertexIndex(GetVertexIndex(target.stop_name)));
+				if (!info) {
+					continue;
+				}
+				const double time = source.walk_time + info->weight.time + target.walk_time;
+				if (!best_source || time < result.total_time) {
+					result.total_time = time;
+					best_source = &source;
+					best_target = &target;
+					edges = info->edges;
+				}
+			}
+		}
+		if (!best_source) {
+			return std::nullopt;
+		}
+	}
+	else {
+		// Один поиск от дублеров всех остановок начала до дублеров всех остановок конца
+		auto to_vertices = [this](const std::vector<RouteEndpoint>& endpoints) {
+			std::vector<std::pair<graph::VertexId, GraphWeight>> result;
+			for (const auto& endpoint : endpoints) {
+				result.push_back({ GetWaitVertexIndex(GetVertexIndex(endpoint.stop_name)),
+					GraphWeight{ .time = endpoint.walk_time, .bus_name = {} } });
+			}
+			return result;
+		};
+		const auto target_vertices = to_vertices(targets);
+
+		const auto info = astar_router_.BuildRoute(to_vertices(sources), target_vertices,
+			[this, &target_vertices](graph::VertexId vertex) {
+				GraphWeight estimate{ .time = std::numeric_limits<double>::infinity(), .bus_name = {} };
+				for (const auto& [target_vertex, target_weight] : target_vertices) {
+					estimate = std::min(estimate, EstimateRemainingTime(vertex, target_vertex) + target_weight);
+				}
+				return estimate;
+			});
+		if (!info) {
+			return std::nullopt;
+		}
+
+		// Если остановка встречается несколько раз, используется наименьшее время пешего пути
+		auto find_endpoint = [this](const std::vector<RouteEndpoint>& endpoints, graph::VertexId vertex) {
+			const RouteEndpoint* result = nullptr;
+			for (const auto& endpoint : endpoints) {
+				if (endpoint.stop_name == GetStopName(vertex) && (!result || endpoint.walk_time < result->walk_time)) {
+					result = &endpoint;
+				}
+			}
+			return result;
+		};
+		best_source = find_endpoint(sources, info->from);
+		best_target = find_endpoint(targets, info->to);
+		edges = info->route.edges;
+	}
+
+	for (const auto edge_index : edges) {
+		result.items.push_back(CreateRouteItem(edge_index));
+	}
+	const double table_time = result.total_time;
+	InsertWalkItems(result, *best_source, *best_target);
+	if (router_) {
+		// Как и для маршрута между остановками, в режиме all_pairs время берется из таблицы
+		result.total_time = table_time;
+	}
+	return result;
+}
+
+const std::optional<std::vector<ReachableStop>> TransportRoute::GetReachableStops(std::string_view from,
+	double max_time) const
+{
+	if (raptor_router_) {
+		return raptor_router_->GetReachableStops(from, max_time);
+	}
+
+	if (!IsCorrectStop(from)) {
+		return std::nullopt;
+	}
+
+	const auto weights = astar_router_.ComputeWeightsWithin(GetWaitVertexIndex(GetVertexIndex(from)),
+		GraphWeight{ .time = max_time, .bus_name = {} });
+
+	// Прибытие на остановку - это попадание в ее дублер
+	std::vector<ReachableStop> result;
+	for (const auto& [vertex, weight] : weights) {
+		if (vertex % 2 == 0) {
+			result.push_back({ GetStopName(vertex), weight.time });
+		}
+	}
+	SortReachableStops(result);
+
+	return result;
+}
+
+std::vector<RouteEndpoint> TransportRoute::GetRouteEndpoints(
+	std::span<const transport_catalogue::detail::StopDistance> stops) const
+{
+	// Перевод метров в минуты для пешехода
+	const double walk_time_coef = 60 / (settings_.walking_velocity * 1000);
+
+	std::vector<RouteEndpoint> result;
+	for (const auto& [stop, distance] : stops) {
+		if (raptor_router_ || IsCorrectStop(stop)) {
+			result.push_back({ stop->name, distance * walk_time_coef });
+		}
+	}
+	return result;
+}
+
 void TransportRoute::AddVertexsToRoute(const Catalogue& catalogue, Graph& graph) {
 	const auto stops = catalogue.GetUniqueStops();
 
-	graph = Graph(stops.size() * 2);          // задаем размер графа
-	index_to_stops_.resize(stops.size());     // и размер вектора
+	graph = Graph(stops.size() * 2);               // задаем размер графа
+	index_to_stops_.reserve(stops.size());         // и размер векторов
+	index_to_stop_ptrs_.reserve(stops.size());
 	for (const auto stop : stops) {
-		AddVertex(stop->name, graph);
+		AddVertex(stop, graph);
 	}
 }
 
-void TransportRoute::AddVertex(std::string_view stop, Graph& graph) {
+void TransportRoute::AddVertex(const domain::Stop* stop, Graph& graph) {
 
 	size_t index = (stops_to_index_.size() * 2) + 1;
+	while (graph.GetVertexCount() <= index) {
+		graph.AddVertex();
+	}
 
-	stops_to_index_.insert({ stop, index });
-	index_to_stops_[GetVertexIndex(stop) / 2] = stop;
+	stops_to_index_.insert({ stop->name, index });
+	if (stop_id_to_index_.size() <= stop->id) {
+		stop_id_to_index_.resize(stop->id + 1, 0);
+	}
+	stop_id_to_index_[stop->id] = index;
+	index_to_stops_.push_back(stop->name_handle);
+	index_to_stop_ptrs_.push_back(stop);
 
 	graph.AddEdge(GraphEdge{
-		.from = GetWaitVertexIndex(GetVertexIndex(stop)),
-		.to = GetVertexIndex(stop),
+		.from = GetWaitVertexIndex(index),
+		.to = index,
 		.weight = {.time = bus_wait_time_, .bus_name = {}} });
 }
 
-void TransportRoute::AddBusEdges(const domain::Bus* bus, const Catalogue& catalogue, Graph& graph) {
-	const auto stops_by_bus = bus->bus_stops;
+void TransportRoute::UpdateMinTimePerMeter(const domain::Bus* bus) {
+	const auto& stops_by_bus = bus->bus_stops;
+	for (size_t i = 1; i < stops_by_bus.size(); ++i) {
+		const double geo_distance = geo::ComputeDistance(stops_by_bus[i - 1]->coordinates,
+			stops_by_bus[i - 1]->latitude_trig, stops_by_bus[i]->coordinates, stops_by_bus[i]->latitude_trig);
+		if (geo_distance > 0) {
+			const double time = bus->GetDistance(i - 1, i) * time_coef_;
+			min_time_per_meter_ = std::min(min_time_per_meter_, time / geo_distance);
+		}
+	}
+}
+
+GraphWeight TransportRoute::EstimateRemainingTime(graph::VertexId vertex, graph::VertexId target) const {
+	if (vertex == target) {
+		return {};
+	}
+	double time = 0.0;
+	if (!std::isinf(min_time_per_meter_)) {
+		const domain::Stop* stop = index_to_stop_ptrs_[vertex / 2];
+		const domain::Stop* target_stop = index_to_stop_ptrs_[target / 2];
+		time = geo::ComputeDistance(stop->coordinates, stop->latitude_trig,
+			target_stop->coordinates, target_stop->latitude_trig) * min_time_per_meter_;
+	}
+
+	// Из дублера остановки (кроме целевой) не уехать, не дождавшись автобуса
+	if (vertex % 2 == 0) {
+		time += bus_wait_time_;
+	}
+
+	if (landmarks_count_ > 0) {
+		time = std::max(time, EstimateLandmarkTime(vertex, target));
+	}
+	return { .time = time, .bus_name = {} };
+}
+
+double TransportRoute::EstimateLandmarkTime(graph::VertexId vertex, graph::VertexId target) const {
+	const size_t vertex_count = graph_.GetVertexCount();
+	double result = 0.0;
+
+	for (size_t offset = 0; offset < landmarks_count_ * vertex_count; offset += vertex_count) {
+		const double from_landmark_to_vertex = landmark_times_from_[offset + vertex];
+		const double from_landmark_to_target = landmark_times_from_[offset + target];
+		if (!std::isinf(from_landmark_to_vertex) && !std::isinf(from_landmark_to_target)) {
+			result = std::max(result, from_landmark_to_target - from_landmark_to_vertex);
+		}
+
+		const double from_vertex_to_landmark = landmark_times_to_[offset + vertex];
+		const double from_target_to_landmark = landmark_times_to_[offset + target];
+		if (!std::isinf(from_vertex_to_landmark) && !std::isinf(from_target_to_landmark)) {
+			result = std::max(result, from_vertex_to_landmark - from_target_to_landmark);
+		}
+	}
+	return result;
+}
+
+// Переводит веса путей, найденные AStarRouter, во времена (бесконечность для недостижимых вершин)
+void AppendTimes(const std::vector<std::optional<GraphWeight>>& weights, std::vector<double>& times) {
+	for (const auto& weight : weights) {
+		times.push_back(weight ? weight->time : std::numeric_limits<double>::infinity());
+	}
+}
+
+void TransportRoute::BuildLandmarks(size_t landmarks_count) {
+	// Запрошенное количество сохраняется, чтобы после роста графа вернуться к нему
+	settings_.landmarks_count = landmarks_count;
+	const size_t vertex_count = graph_.GetVertexCount();
+	landmarks_count = std::min(landmarks_count, vertex_count);
+
+	landmarks_count_ = 0;
+	landmark_times_from_.clear();
+	landmark_times_to_.clear();
+	if (landmarks_count == 0) {
+		return;
+	}
+	landmark_times_from_.reserve(landmarks_count * vertex_count);
+	landmark_times_to_.reserve(landmarks_count * vertex_count);
+
+	// Граф с развернутыми ребрами - для поиска путей от всех вершин до ориентира
+	Graph reversed_graph(vertex_count);
+	for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+		const auto& edge = graph_.GetEdge(edge_id);
+		reversed_graph.AddEdge(GraphEdge{ .from = edge.to, .to = edge.from, .weight = edge.weight });
+	}
+	const graph::AStarRouter<GraphWeight> reversed_router(reversed_graph);
+
+	// Ориентиры выбираются "жадно": очередной ориентир - вершина, наиболее удаленная
+	// от уже выбранных ориентиров и от вершины 0
+	std::vector<double> distance_to_landmarks;
+	distance_to_landmarks.reserve(vertex_count);
+	AppendTimes(astar_router_.ComputeWeightsFrom(0), distance_to_landmarks);
+
+	while (landmarks_count_ < landmarks_count) {
+		const auto landmark = static_cast<graph::VertexId>(std::distance(distance_to_landmarks.begin(),
+			std::max_element(distance_to_landmarks.begin(), distance_to_landmarks.end())));
+
+		AppendTimes(astar_router_.ComputeWeightsFrom(landmark), landmark_times_from_);
+		AppendTimes(reversed_router.ComputeWeightsFrom(landmark), landmark_times_to_);
+
+		const size_t offset = landmarks_count_ * vertex_count;
+		for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+			distance_to_landmarks[vertex] = std::min(distance_to_landmarks[vertex],
+				landmark_times_from_[offset + vertex]);
+		}
+		++landmarks_count_;
+	}
+}
+
+void TransportRoute::AddStopEdges(const domain::Bus& bus, size_t start_index, size_t end_index, Graph& graph) {
+	const graph::VertexId start_vertex = GetVertexIndex(bus.bus_stops[start_index]);
+
+	for (size_t i = start_index + 1; i < end_index; ++i) {
+		graph.AddEdge(GraphEdge{
+			.from = start_vertex,
+			.to = GetWaitVertexIndex(GetVertexIndex(bus.bus_stops[i])),
+			.weight = {
+				.time = bus.GetDistance(start_index, i) * time_coef_,
+				.span_count = static_cast<int>(i - start_index),
+				.bus_name = bus.name_handle } });
+	}
+}
+
+void TransportRoute::AddBusEdges(const domain::Bus* bus, Graph& graph) {
+	const size_t stops_count = bus->bus_stops.size();
 	if (bus->is_roundtrip) {
-		for (size_t i = 0; i < stops_by_bus.size() - 1; ++i) {
-			AddStopEdges(stops_by_bus.begin() + i, stops_by_bus.end(), catalogue, bus->name, graph);
+		for (size_t i = 0; i + 1 < stops_count; ++i) {
+			AddStopEdges(*bus, i, stops_count, graph);
 		}
 	}
 	else {
-		size_t half_range = stops_by_bus.size() / 2;
+		size_t half_range = stops_count / 2;
 
 		for (size_t i = 0; i < half_range; ++i) {
-			AddStopEdges(stops_by_bus.begin() + i, stops_by_bus.end() - half_range, catalogue, bus->name, graph);
+			AddStopEdges(*bus, i, stops_count - half_range, graph);
 		}
 
-		for (size_t i = half_range; i < stops_by_bus.size() - 1; ++i) {
-			AddStopEdges(stops_by_bus.begin() + i, stops_by_bus.end(), catalogue, bus->name, graph);
+		for (size_t i = half_range; i + 1 < stops_count; ++i) {
+			AddStopEdges(*bus, i, stops_count, graph);
 		}
 	}
 }
@@ -95,7 +370,100 @@ TransportRoute::Graph TransportRoute::BuildGraph(const Catalogue& catalogue) {
 void TransportRoute::AddEdges(const Catalogue& catalogue, Graph& graph) {
 	const auto buses = catalogue.GetUniqueBuses();
 	for (const auto bus : buses) {
-		AddBusEdges(bus, catalogue, graph);
+		const graph::EdgeId first_edge = graph.GetEdgeCount();
+		AddBusEdges(bus, graph);
+		bus_to_edges_[bus->name] = { first_edge, graph.GetEdgeCount() };
+		UpdateMinTimePerMeter(bus);
+	}
+}
+
+void TransportRoute::AddBus(const Catalogue& catalogue, const domain::Bus& bus) {
+	// RAPTOR не требует предварительной обработки, кроме раскладки линий по массивам
+	if (raptor_router_) {
+		raptor_router_.emplace(catalogue);
+		return;
+	}
+
+	const graph::EdgeId first_new_edge = graph_.GetEdgeCount();
+	for (const auto stop : bus.bus_stops) {
+		if (!IsCorrectStop(stop)) {
+			AddVertex(stop, graph_);
+		}
+	}
+
+	const graph::EdgeId first_bus_edge = graph_.GetEdgeCount();
+	AddBusEdges(&bus, graph_);
+	bus_to_edges_[bus.name] = { first_bus_edge, graph_.GetEdgeCount() };
+	UpdateMinTimePerMeter(&bus);
+
+	std::vector<graph::EdgeId> new_edges(graph_.GetEdgeCount() - first_new_edge);
+	std::iota(new_edges.begin(), new_edges.end(), first_new_edge);
+	UpdateRouters(new_edges, false);
+}
+
+void TransportRoute::UpdateDistance(const Catalogue& catalogue, std::string_view first_stop,
+	std::string_view second_stop)
+{
+	if (raptor_router_) {
+		raptor_router_.emplace(catalogue);
+		return;
+	}
+
+	// Остановки, через которые не проходит ни один маршрут, не влияют на граф
+	if (!IsCorrectStop(first_stop) || !IsCorrectStop(second_stop)) {
+		return;
+	}
+
+	std::vector<graph::EdgeId> decreased_edges;
+	bool has_increased_edges = false;
+
+	for (const auto bus_name : catalogue.GetBusesByStop(first_stop)) {
+		const auto bus = catalogue.GetBus(bus_name);
+
+		// Ребра маршрута строятся заново во временном графе в том же порядке, что и в graph_
+		Graph bus_graph(graph_.GetVertexCount());
+		AddBusEdges(bus, bus_graph);
+
+		const auto [first_edge, last_edge] = bus_to_edges_.at(bus_name);
+		for (graph::EdgeId edge_id = first_edge; edge_id < last_edge; ++edge_id) {
+			const GraphWeight& new_weight = bus_graph.GetEdge(edge_id - first_edge).weight;
+			const GraphWeight& old_weight = graph_.GetEdge(edge_id).weight;
+			if (new_weight < old_weight) {
+				decreased_edges.push_back(edge_id);
+			}
+			else if (old_weight < new_weight) {
+				has_increased_edges = true;
+			}
+			else {
+				continue;
+			}
+			graph_.SetEdgeWeight(edge_id, new_weight);
+		}
+		UpdateMinTimePerMeter(bus);
+	}
+
+	UpdateRouters(decreased_edges, has_increased_edges);
+}
+
+void TransportRoute::UpdateRouters(const std::vector<graph::EdgeId>& changed_edges, bool has_increased_edges) {
+	if (!has_increased_edges && changed_edges.empty()) {
+		return;
+	}
+
+	// Увеличение веса ребра не выражается через релаксацию, в этом случае таблица строится заново
+	if (router_) {
+		if (has_increased_edges) {
+			router_->Rebuild();
+		}
+		else {
+			router_->UpdateEdges(changed_edges);
+		}
+	}
+
+	// Любое изменение весов может нарушить оценки по ориентирам, поэтому они вычисляются заново.
+	// Количество берется из настроек: landmarks_count_ ограничено числом вершин прежнего графа
+	if (settings_.mode == RouterMode::ALT || landmarks_count_ > 0) {
+		BuildLandmarks(settings_.landmarks_count);
 	}
 }
 
@@ -113,7 +481,7 @@ RouteItem TransportRoute::CreateRouteItem(size_t edge_index) const {
 			.type = RouteType::BUS,
 			.span_count = edge.weight.span_count,
 			.time = edge.weight.time,
-			.data = edge.weight.bus_name
+			.data = names_->GetString(edge.weight.bus_name)
 		};
 	}
 }
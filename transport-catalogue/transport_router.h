@@ -1,8 +1,14 @@
 #pragma once
 
+#include "astar_router.h"
+#include "raptor_router.h"
 #include "router.h"
+#include "router_information.h"
 #include "transport_catalogue.h"
 
+#include <limits>
+#include <optional>
+#include <span>
 #include <vector>
 #include <unordered_map>
 
@@ -14,26 +20,33 @@ struct GraphWeight
 {
 	double time = 0.0;
 	int span_count = 0;
-	std::string_view bus_name;
+	// Дескриптор названия маршрута в пуле строк TransportCatalogue (только для ребер поездок)
+	transport_catalogue::detail::StringPool::Handle bus_name = 0;
 };
 
 bool operator<(const GraphWeight& lhs, const GraphWeight& rhs);
 bool operator>(const GraphWeight& lhs, const GraphWeight& rhs);
 GraphWeight operator+(const GraphWeight& lhs, const GraphWeight& rhs);
 
-enum RouteType { WAIT, BUS };
-
-struct RouteItem
-{
-	RouteType type;
-	int span_count = 0;
-	double time = 0.0;
-	std::string_view data;
+// Способ поиска маршрута
+enum class RouterMode {
+	ALL_PAIRS,    // таблица кратчайших путей между всеми парами вершин (graph::Router)
+	A_STAR,       // поиск A* на каждый запрос с географической нижней оценкой времени
+	ALT,          // поиск A* с оценкой по ориентирам (landmarks) и неравенству треугольника
+	RAPTOR        // граф не строится, поиск ведется по последовательностям остановок маршрутов (RaptorRoute)
 };
 
-struct RouterInformation {
-	double total_time = 0.0;
-	std::vector<RouteItem> items;
+// Структура для хранения настроек TransportRoute
+struct RoutingSettings {
+	RouterMode mode = RouterMode::ALL_PAIRS;
+
+	// Количество ориентиров для режима ALT
+	size_t landmarks_count = 8;
+
+	// Скорость пешехода в км/ч и количество ближайших остановок, до которых можно дойти пешком
+	// в начале и в конце маршрута между точками
+	double walking_velocity = 5.0;
+	size_t walk_stops_count = 3;
 };
 
 class TransportRoute {
@@ -45,43 +58,118 @@ private:
 
 public:
 
-	TransportRoute(const Catalogue& catalogue)
-		:bus_wait_time_(static_cast<double>(catalogue.GetBusWaitTime()))
+	TransportRoute(const Catalogue& catalogue, RoutingSettings settings = {})
+		:settings_(settings)
+		,names_(&catalogue.GetNames())
+		,bus_wait_time_(static_cast<double>(catalogue.GetBusWaitTime()))
 		,time_coef_(60 / (catalogue.GetBusVelocity() * 1000))
-		,graph_(BuildGraph(catalogue))
-		,router_(graph_)
+		,graph_((settings_.mode == RouterMode::RAPTOR) ? Graph{} : BuildGraph(catalogue))
+		,astar_router_(graph_)
 	{
+		// Таблица всех пар вершин строится за O(V^3), поэтому только если она нужна
+		if (settings_.mode == RouterMode::ALL_PAIRS) {
+			router_.emplace(graph_);
+		}
+		else if (settings_.mode == RouterMode::ALT) {
+			BuildLandmarks(settings_.landmarks_count);
+		}
+		else if (settings_.mode == RouterMode::RAPTOR) {
+			raptor_router_.emplace(catalogue);
+		}
 	}
 
 	const std::optional<RouterInformation> GetRouteInfo(std::string_view from, std::string_view to) const;
 
+	// Возвращает маршрут между точками: from_stops и to_stops - ближайшие к начальной и конечной точкам
+	// остановки маршрутов (TransportCatalogue::GetNearestServedStops) и расстояния до них, проходимые
+	// пешком. Выбирается наилучшее сочетание остановок за один поиск
+	const std::optional<RouterInformation> GetRouteInfo(
+		std::span<const transport_catalogue::detail::StopDistance> from_stops,
+		std::span<const transport_catalogue::detail::StopDistance> to_stops) const;
+
+	const RoutingSettings& GetSettings() const { return settings_; }
+
+	// Возвращает все остановки, до которых можно добраться от остановки from не более чем за max_time минут,
+	// упорядоченные по времени пути (запрос Isochrone)
+	const std::optional<std::vector<ReachableStop>> GetReachableStops(std::string_view from, double max_time) const;
+
+	// Учитывает маршрут bus, добавленный в catalogue после построения TransportRoute:
+	// добавляет в граф вершины новых остановок и ребра маршрута и дополняет структуры поиска
+	// без их полного перестроения
+	void AddBus(const Catalogue& catalogue, const domain::Bus& bus);
+
+	// Учитывает добавленное или измененное в catalogue расстояние между остановками first_stop
+	// и second_stop: пересчитывает веса ребер маршрутов, проходящих через эти остановки
+	void UpdateDistance(const Catalogue& catalogue, std::string_view first_stop, std::string_view second_stop);
+
+	// Выбирает landmarks_count ориентиров и заново вычисляет времена пути от них до всех вершин графа
+	// и от всех вершин до них (не больше, чем вершин в графе). Вызывается при построении в режиме ALT,
+	// а также может быть вызвана повторно для смены количества ориентиров без перестроения графа.
+	// Запрошенное количество сохраняется в настройках и используется при обновлении графа
+	void BuildLandmarks(size_t landmarks_count);
+
 private:
 
+	RoutingSettings settings_;
+
+	// Пул названий TransportCatalogue, по которому дескрипторы переводятся в названия для ответов
+	const transport_catalogue::detail::StringPool* names_ = nullptr;
+
 	double bus_wait_time_ = 0.0;
 	double time_coef_ = 0.0;
 
-	// Контейнеры для хранения остановок (дублеры в контейнерах не хранятся)
+	// Минимальное время проезда одного метра по прямой (в минутах) среди всех перегонов сети,
+	// т.е. величина, обратная максимальной "географической" скорости автобуса
+	double min_time_per_meter_ = std::numeric_limits<double>::infinity();
+
+	// Контейнеры для хранения остановок (дублеры в контейнерах не хранятся),
+	// index_to_stops_ хранит дескрипторы названий
 	std::unordered_map<std::string_view, size_t> stops_to_index_;
-	std::vector<std::string_view> index_to_stops_;
+	std::vector<transport_catalogue::detail::StringPool::Handle> index_to_stops_;
+	std::vector<const domain::Stop*> index_to_stop_ptrs_;
+	// Индексы вершин остановок по идентификаторам domain::Stop::id (0 - остановки нет в графе,
+	// т.к. индексы остановок нечетные)
+	std::vector<size_t> stop_id_to_index_;
+
+	// Времена пути от ориентиров до вершин графа и от вершин до ориентиров, хранятся построчно:
+	// landmark_times_from_[i * V + v] - время пути от i-го ориентира до вершины v,
+	// landmark_times_to_[i * V + v] - время пути от вершины v до i-го ориентира
+	// (бесконечность, если путь не существует)
+	size_t landmarks_count_ = 0;
+	std::vector<double> landmark_times_from_;
+	std::vector<double> landmark_times_to_;
+
+	// Диапазоны индексов [first, second) ребер маршрутов Bus в графе
+	std::unordered_map<std::string_view, std::pair<graph::EdgeId, graph::EdgeId>> bus_to_edges_;
 
 	// Вершины графа это остановки маршрутов TransportCatalogue и их дублеры
 	// дублеры нужны для учета времени ожидания автобуса равное bus_wait_time_
 	// индексы дублеров - четные, остановок - нечетные (индекс дублера + 1)
 	Graph graph_;
-	graph::Router<GraphWeight> router_;
+	std::optional<graph::Router<GraphWeight>> router_;
+	graph::AStarRouter<GraphWeight> astar_router_;
+	std::optional<RaptorRoute> raptor_router_;
 
 	bool IsCorrectStop(std::string_view stop_name) const {
 		return stops_to_index_.count(stop_name);
 	}
 
+	bool IsCorrectStop(const domain::Stop* stop) const {
+		return stop->id < stop_id_to_index_.size() && stop_id_to_index_[stop->id] != 0;
+	}
+
 	std::string_view GetStopName(size_t index) const {
-		return index_to_stops_[index / 2];
+		return names_->GetString(index_to_stops_[index / 2]);
 	}
 
 	size_t GetVertexIndex(std::string_view stop_name) const {
 		return stops_to_index_.at(stop_name);
 	}
 
+	size_t GetVertexIndex(const domain::Stop* stop) const {
+		return stop_id_to_index_[stop->id];
+	}
+
 	// Для доступа к индексу дублера
 	size_t GetWaitVertexIndex(size_t index) const {
 		return index - 1;
@@ -91,39 +179,42 @@ private:
 	void AddVertexsToRoute(const Catalogue& catalogue, Graph& graph);
 
 	// Добавляет вершину (остановку) в словарь stops_to_index_ и добавляет ребро между ними в граф
-	void AddVertex(std::string_view stop, Graph& graph);
-
-	// Добавляет ребра от остановки start_range до всех остановок диапазона start_range + 1 ... end_range
-	template <typename It>
-	void AddStopEdges(It start_range, It end_range, const Catalogue& catalogue, std::string_view bus_name, Graph& graph) {
-		const auto start_stop = *start_range;
-		int weight_sum = 0, span_counter = 0;
-
-		for (auto lhs = start_range, rhs = start_range + 1; rhs != end_range; ++lhs, ++rhs) {
-			++span_counter;
-			const auto lhs_stop = *lhs, rhs_stop = *rhs;
-
-			weight_sum += catalogue.GetDistanceBetweenStops(lhs_stop->name, rhs_stop->name);
-			double edge_weight = 0.0;
-			(start_range == rhs) ? edge_weight = bus_wait_time_
-				: edge_weight = weight_sum * time_coef_;
-
-			graph.AddEdge(GraphEdge{
-				.from = GetVertexIndex(start_stop->name),
-				.to = GetWaitVertexIndex(GetVertexIndex(rhs_stop->name)),
-				.weight = {.time = edge_weight, .span_count = span_counter, .bus_name = bus_name} });
-		}
-	}
+	// (при необходимости увеличивая количество вершин графа)
+	void AddVertex(const domain::Stop* stop, Graph& graph);
+
+	// Учитывает перегоны маршрута при вычислении min_time_per_meter_
+	void UpdateMinTimePerMeter(const domain::Bus* bus);
+
+	// Возвращает нижнюю оценку времени пути от вершины vertex до вершины target:
+	// время проезда расстояния по прямой с максимальной скоростью
+	// плюс время ожидания автобуса, если поездка еще не началась.
+	// Если построены ориентиры, берется максимум с оценкой EstimateLandmarkTime
+	GraphWeight EstimateRemainingTime(graph::VertexId vertex, graph::VertexId target) const;
+
+	// Возвращает нижнюю оценку времени пути по неравенству треугольника для всех ориентиров L:
+	// max(d(L, target) - d(L, vertex), d(vertex, L) - d(target, L))
+	double EstimateLandmarkTime(graph::VertexId vertex, graph::VertexId target) const;
+
+	// Добавляет ребра от остановки маршрута bus с индексом start_index до всех остановок
+	// с индексами start_index + 1 ... end_index - 1
+	void AddStopEdges(const domain::Bus& bus, size_t start_index, size_t end_index, Graph& graph);
 
 	// Добавляет ребра конкретного маршрута Bus в граф
-	void AddBusEdges(const domain::Bus* bus, const Catalogue& catalogue, Graph& graph);
+	void AddBusEdges(const domain::Bus* bus, Graph& graph);
 
 	// Добавляет в граф ребра между вершинами
 	void AddEdges(const Catalogue& catalogue, Graph& graph);
 
+	// Обновляет структуры поиска после изменения графа: changed_edges - новые ребра и ребра,
+	// вес которых уменьшился, has_increased_edges - увеличился ли вес хотя бы одного ребра
+	void UpdateRouters(const std::vector<graph::EdgeId>& changed_edges, bool has_increased_edges);
+
 	// Строит граф по маршрутами из TransportCatalogue
 	Graph BuildGraph(const Catalogue& catalogue);
 
+	// Возвращает остановки из stops, через которые проходят маршруты, со временем пешего пути до них
+	std::vector<RouteEndpoint> GetRouteEndpoints(std::span<const transport_catalogue::detail::StopDistance> stops) const;
+
 	// Создает RouteItem из ребра графа
 	RouteItem CreateRouteItem(size_t edge_index) const;
 };